@@ -0,0 +1,133 @@
+//
+// lager - library for functional interactive c++ programs
+// Copyright (C) 2017 Juan Pedro Bolivar Puente
+//
+// This file is part of lager.
+//
+// lager is free software: you can redistribute it and/or modify
+// it under the terms of the MIT License, as detailed in the LICENSE
+// file located at the root of this source code distribution,
+// or here: <https://github.com/arximboldi/lager/blob/master/LICENSE>
+//
+
+#include <catch.hpp>
+
+#include <lager/lens.hpp>
+#include <lager/lenses.hpp>
+#include <lager/lenses/at.hpp>
+#include <lager/lenses/attr.hpp>
+
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace {
+
+// The previous implementation of `lager::lens`, kept as a baseline: the lens
+// is always allocated on the heap and shared via an atomic reference count,
+// and accessed through virtual calls.
+template <typename Whole, typename Part>
+struct shared_lens_i
+{
+    virtual ~shared_lens_i()                           = default;
+    virtual Part view(Whole const&) const              = 0;
+    virtual Whole set(Whole const&, Part const&) const = 0;
+};
+
+template <typename Lens, typename Whole, typename Part>
+struct shared_lens_holder : shared_lens_i<Whole, Part>
+{
+    Lens value;
+
+    shared_lens_holder(Lens v)
+        : value{std::move(v)}
+    {}
+
+    Part view(Whole const& w) const override { return lager::view(value, w); }
+
+    Whole set(Whole const& w, Part const& p) const override
+    {
+        return lager::set(value, w, p);
+    }
+};
+
+template <typename Whole, typename Part>
+class shared_lens : zug::detail::pipeable
+{
+    std::shared_ptr<shared_lens_i<Whole, Part> const> holder_;
+
+public:
+    template <typename Lens,
+              std::enable_if_t<!std::is_same_v<std::decay_t<Lens>, shared_lens>,
+                               int> = 0>
+    shared_lens(Lens l)
+        : holder_{std::make_shared<
+              shared_lens_holder<Lens, Whole, Part>>(std::move(l))}
+    {}
+
+    template <typename F>
+    auto operator()(F&& f) const
+    {
+        return [this, f = std::forward<F>(f)](auto&& p) {
+            return f(holder_->view(std::forward<decltype(p)>(p)))(
+                [&](auto&& x) {
+                    return holder_->set(std::forward<decltype(p)>(p),
+                                        std::forward<decltype(x)>(x));
+                });
+        };
+    }
+};
+
+struct point
+{
+    int x = 0;
+    int y = 0;
+};
+
+struct item
+{
+    std::string name;
+    point position;
+    std::vector<int> tags;
+};
+
+template <template <typename, typename> class Lens>
+void run_benchmarks(const char* name)
+{
+    using namespace lager::lenses;
+
+    auto small = Lens<item, int>{attr(&item::position) | attr(&point::x)};
+    auto keyed =
+        Lens<item, std::optional<int>>{attr(&item::tags) | at(std::size_t{2})};
+    auto value = item{"foo", {1, 2}, {1, 2, 3}};
+
+    BENCHMARK(std::string{name} + " view")
+    {
+        return lager::view(small, value);
+    };
+
+    BENCHMARK(std::string{name} + " set")
+    {
+        return lager::set(small, value, 42);
+    };
+
+    BENCHMARK(std::string{name} + " view keyed")
+    {
+        return lager::view(keyed, value);
+    };
+
+    BENCHMARK(std::string{name} + " copy")
+    {
+        auto copies = std::vector<Lens<item, int>>(64, small);
+        return copies.size();
+    };
+}
+
+} // namespace
+
+TEST_CASE("type erased lens")
+{
+    run_benchmarks<lager::lens>("small buffer lens");
+    run_benchmarks<shared_lens>("shared lens");
+}
@@ -0,0 +1,383 @@
+//
+// lager - library for functional interactive c++ programs
+// Copyright (C) 2017 Juan Pedro Bolivar Puente
+//
+// This file is part of lager.
+//
+// lager is free software: you can redistribute it and/or modify
+// it under the terms of the MIT License, as detailed in the LICENSE
+// file located at the root of this source code distribution,
+// or here: <https://github.com/arximboldi/lager/blob/master/LICENSE>
+//
+
+#include <catch.hpp>
+
+#include <lager/event_loop/queue.hpp>
+#include <lager/extra/cereal/struct.hpp>
+#include <lager/extra/cereal/variant_with_name.hpp>
+#include <lager/extra/journal.hpp>
+#include <lager/store.hpp>
+
+#include "../example/autopong/autopong.hpp"
+#include "../example/snake/model.hpp"
+#include "../example/todo/model.hpp"
+
+#include <boost/core/demangle.hpp>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <new>
+#include <optional>
+#include <random>
+#include <string>
+#include <vector>
+
+// Replays sessions of the example models through a store, reporting the
+// throughput, latencies and allocations.  The sessions are made up, except
+// for autopong, which can be read from a journal written by
+// `lager::with_journal`, without snapshots, by setting `LAGER_REPLAY_JOURNAL`
+// to its path.
+//
+// When `LAGER_REPLAY_RESULTS` is set, the allocations and nanoseconds per
+// action of every session are appended to that file.  When
+// `LAGER_REPLAY_BASELINE` is set to such a file, the sessions fail when they
+// allocate more than 10% over it, or are slower than it by more than
+// `LAGER_REPLAY_TIME_TOLERANCE` times, 2 by default.
+
+// Counts the allocations done while replaying.
+namespace {
+std::atomic<std::size_t> allocations{0};
+} // namespace
+
+void* operator new(std::size_t size)
+{
+    ++allocations;
+    if (auto p = std::malloc(size ? size : 1))
+        return p;
+    throw std::bad_alloc{};
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+namespace {
+
+using std::chrono::steady_clock;
+
+template <typename... Ts>
+std::size_t action_index(const std::variant<Ts...>& a)
+{
+    return a.index();
+}
+
+template <typename... Ts>
+std::size_t action_index(const boost::variant<Ts...>& a)
+{
+    return a.which();
+}
+
+template <typename... Ts>
+std::string action_name(const std::variant<Ts...>& a)
+{
+    return std::visit(
+        [](auto&& x) { return boost::core::demangle(typeid(x).name()); }, a);
+}
+
+template <typename... Ts>
+std::string action_name(const boost::variant<Ts...>& a)
+{
+    return boost::core::demangle(a.type().name());
+}
+
+// Latencies of the reducer for one type of action, in buckets of powers of
+// two nanoseconds.
+struct latency_histogram
+{
+    std::string name;
+    std::size_t count = 0;
+    steady_clock::duration total{};
+    steady_clock::duration max{};
+    std::array<std::size_t, 40> buckets{};
+
+    void add(steady_clock::duration t)
+    {
+        auto ns     = std::chrono::nanoseconds{t}.count();
+        auto bucket = std::size_t{};
+        while (ns > 1 && bucket + 1 < buckets.size()) {
+            ns >>= 1;
+            ++bucket;
+        }
+        ++buckets[bucket];
+        ++count;
+        total += t;
+        max = std::max(max, t);
+    }
+};
+
+struct replay_report
+{
+    std::size_t actions     = 0;
+    std::size_t allocations = 0;
+    steady_clock::duration total{};
+    steady_clock::duration reducer{};
+    std::vector<latency_histogram> latencies;
+};
+
+/*!
+ * Dispatches all the `actions` to a store with the initial model `init`, and
+ * measures how long it takes to process them.  The effects returned by the
+ * `reducer` are discarded, so the replay is deterministic.
+ */
+template <typename Action, typename Model, typename Reducer>
+replay_report
+replay(Model init, const std::vector<Action>& actions, Reducer reducer)
+{
+    auto report = replay_report{};
+    for (auto& a : actions) {
+        auto index = action_index(a);
+        if (report.latencies.size() <= index)
+            report.latencies.resize(index + 1);
+        if (report.latencies[index].name.empty())
+            report.latencies[index].name = action_name(a);
+    }
+
+    auto loop  = lager::queue_event_loop{};
+    auto store = lager::make_store<Action, lager::automatic_tag>(
+        std::move(init),
+        lager::with_queue_event_loop{loop},
+        lager::with_reducer([&](Model m, Action a) {
+            auto start  = steady_clock::now();
+            auto result = lager::invoke_reducer(
+                reducer, std::move(m), a, [](auto&&) {}, [] {});
+            auto t = steady_clock::now() - start;
+            report.reducer += t;
+            report.latencies[action_index(a)].add(t);
+            return result;
+        }));
+
+    auto allocations_before = allocations.load();
+    auto start              = steady_clock::now();
+    for (auto& a : actions) {
+        store.dispatch(a);
+        loop.step();
+    }
+    report.total       = steady_clock::now() - start;
+    report.allocations = allocations.load() - allocations_before;
+    report.actions     = actions.size();
+    return report;
+}
+
+void print_report(const std::string& name, const replay_report& r)
+{
+    using ns_t       = std::chrono::duration<double, std::nano>;
+    using seconds_t  = std::chrono::duration<double>;
+    auto propagation = r.total - r.reducer;
+    std::cout << name << ": " << r.actions << " actions, "
+              << r.actions / seconds_t{r.total}.count() << " actions/s, "
+              << ns_t{r.reducer}.count() / r.actions << " ns/action reducing, "
+              << ns_t{propagation}.count() / r.actions
+              << " ns/action propagating, "
+              << double(r.allocations) / r.actions << " allocations/action\n";
+    for (auto& h : r.latencies) {
+        if (!h.count)
+            continue;
+        std::cout << "  " << h.name << ": " << h.count << " actions, "
+                  << ns_t{h.total}.count() / h.count << " ns mean, "
+                  << ns_t{h.max}.count() << " ns max\n   ";
+        for (auto i = std::size_t{}; i < h.buckets.size(); ++i)
+            if (h.buckets[i])
+                std::cout << " <" << (std::uint64_t{2} << i)
+                          << "ns: " << h.buckets[i];
+        std::cout << "\n";
+    }
+}
+
+struct replay_summary
+{
+    double allocations = 0;
+    double ns          = 0;
+};
+
+std::optional<replay_summary> read_baseline(const std::string& name)
+{
+    auto path = std::getenv("LAGER_REPLAY_BASELINE");
+    if (!path)
+        return std::nullopt;
+    auto is    = std::ifstream{path};
+    auto entry = std::string{};
+    auto s     = replay_summary{};
+    while (is >> entry >> s.allocations >> s.ns)
+        if (entry == name)
+            return s;
+    return std::nullopt;
+}
+
+void check_baseline(const std::string& name, const replay_report& r)
+{
+    using ns_t = std::chrono::duration<double, std::nano>;
+    auto s     = replay_summary{double(r.allocations) / r.actions,
+                            ns_t{r.total}.count() / r.actions};
+    if (auto path = std::getenv("LAGER_REPLAY_RESULTS")) {
+        auto os = std::ofstream{path, std::ios::app};
+        os << name << " " << s.allocations << " " << s.ns << "\n";
+    }
+    if (auto baseline = read_baseline(name)) {
+        auto tolerance = 2.0;
+        if (auto t = std::getenv("LAGER_REPLAY_TIME_TOLERANCE"))
+            tolerance = std::atof(t);
+        INFO(name << ": " << s.allocations << " allocations/action and "
+                  << s.ns << " ns/action, baseline "
+                  << baseline->allocations << " allocations/action and "
+                  << baseline->ns << " ns/action");
+        CHECK(s.allocations <= baseline->allocations * 1.1);
+        CHECK(s.ns <= baseline->ns * tolerance);
+    }
+}
+
+template <typename Action, typename Model, typename Reducer>
+void run_benchmarks(const std::string& name,
+                    const Model& init,
+                    const std::vector<Action>& actions,
+                    Reducer reducer)
+{
+    auto report = replay(init, actions, reducer);
+    print_report(name, report);
+    check_baseline(name, report);
+
+    BENCHMARK(name + " replay")
+    {
+        return replay(init, actions, reducer).actions;
+    };
+}
+
+constexpr auto num_actions = std::size_t{10000};
+
+std::vector<todo::model_action> record_todo()
+{
+    auto gen     = std::mt19937{42};
+    auto actions = std::vector<todo::model_action>{};
+    auto size    = std::size_t{};
+    for (auto i = std::size_t{}; i < num_actions; ++i) {
+        auto dice = gen() % 10;
+        if (size == 0 || dice < 4) {
+            actions.push_back(
+                todo::add_todo_action{"todo number " + std::to_string(i)});
+            ++size;
+        } else if (dice < 9) {
+            auto action = todo::item_action{todo::toggle_item_action{}};
+            actions.push_back(std::pair{gen() % size, action});
+        } else {
+            auto action = todo::item_action{todo::remove_item_action{}};
+            actions.push_back(std::pair{gen() % size, action});
+            --size;
+        }
+    }
+    return actions;
+}
+
+std::vector<sn::action_t> record_snake()
+{
+    auto gen     = std::mt19937{42};
+    auto actions = std::vector<sn::action_t>{};
+    for (auto i = std::size_t{}; i < num_actions; ++i) {
+        switch (gen() % 16) {
+        case 0:
+            actions.push_back(sn::go_left{});
+            break;
+        case 1:
+            actions.push_back(sn::go_right{});
+            break;
+        case 2:
+            actions.push_back(sn::go_up{});
+            break;
+        case 3:
+            actions.push_back(sn::go_down{});
+            break;
+        case 4:
+            actions.push_back(sn::reset{});
+            break;
+        default:
+            actions.push_back(sn::tick{});
+            break;
+        }
+    }
+    return actions;
+}
+
+std::vector<autopong::action> read_autopong(const std::string& path)
+{
+    auto actions = std::vector<autopong::action>{};
+    lager::detail::read_journal<autopong::action>(
+        path, 0, [&](autopong::action&& a) {
+            actions.push_back(std::move(a));
+        });
+    return actions;
+}
+
+// Plays autopong through a store that records the actions in a journal, and
+// reads them back from the journal file, as a replay of a real session would.
+std::vector<autopong::action> record_autopong()
+{
+    auto path =
+        std::filesystem::temp_directory_path() / "lager-replay-autopong";
+    std::filesystem::remove(path);
+    {
+        auto gen   = std::mt19937{42};
+        auto loop  = lager::queue_event_loop{};
+        auto store = lager::make_store<autopong::action>(
+            autopong::model{},
+            lager::with_queue_event_loop{loop},
+            lager::with_journal(path.string()));
+        for (auto i = std::size_t{}; i < num_actions; ++i) {
+            if (gen() % 4 == 0)
+                store.dispatch(autopong::paddle_move_action{
+                    static_cast<float>(gen() % 21) - 10.f});
+            else
+                store.dispatch(autopong::tick_action{16.f});
+            loop.step();
+        }
+    }
+    auto actions = read_autopong(path.string());
+    std::filesystem::remove(path);
+    return actions;
+}
+
+} // namespace
+
+TEST_CASE("todo")
+{
+    run_benchmarks("todo",
+                   todo::model{},
+                   record_todo(),
+                   [](todo::model m, todo::model_action a) {
+                       return todo::update(std::move(m), std::move(a));
+                   });
+}
+
+TEST_CASE("snake")
+{
+    run_benchmarks("snake",
+                   sn::make_initial(42),
+                   record_snake(),
+                   [](sn::app_model m, sn::action_t a) {
+                       return sn::update(std::move(m), std::move(a));
+                   });
+}
+
+TEST_CASE("autopong")
+{
+    auto journal = std::getenv("LAGER_REPLAY_JOURNAL");
+    auto actions = journal ? read_autopong(journal) : record_autopong();
+    REQUIRE(!actions.empty());
+    run_benchmarks(journal ? "autopong-journal" : "autopong",
+                   autopong::model{},
+                   actions,
+                   [](autopong::model m, autopong::action a) {
+                       return autopong::update(m, a);
+                   });
+}
@@ -0,0 +1,315 @@
+//
+// lager - library for functional interactive c++ programs
+// Copyright (C) 2017 Juan Pedro Bolivar Puente
+//
+// This file is part of lager.
+//
+// lager is free software: you can redistribute it and/or modify
+// it under the terms of the MIT License, as detailed in the LICENSE
+// file located at the root of this source code distribution,
+// or here: <https://github.com/arximboldi/lager/blob/master/LICENSE>
+//
+
+#pragma once
+
+#include <lager/detail/immer_traits.hpp>
+#include <lager/detail/sequence.hpp>
+#include <lager/reader.hpp>
+
+#include <immer/algorithm.hpp>
+#include <immer/flex_vector.hpp>
+#include <immer/map.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+namespace lager {
+
+namespace detail {
+
+template <typename Container, typename Fn>
+auto each_result_impl()
+{
+    if constexpr (is_immer_map_v<Container>) {
+        using result_t = std::decay_t<std::invoke_result_t<
+            Fn,
+            const typename Container::mapped_type&>>;
+        return immer::map<typename Container::key_type, result_t>{};
+    } else {
+        using result_t = std::decay_t<
+            std::invoke_result_t<Fn, const typename Container::value_type&>>;
+        return immer::flex_vector<result_t>{};
+    }
+}
+
+template <typename Container>
+auto filter_result_impl()
+{
+    if constexpr (is_immer_map_v<Container>)
+        return Container{};
+    else
+        return immer::flex_vector<typename Container::value_type>{};
+}
+
+template <typename Container, typename Fn>
+using each_result_t = decltype(each_result_impl<Container, Fn>());
+
+template <typename Container>
+using filter_result_t = decltype(filter_result_impl<Container>());
+
+/*!
+ * Base class for nodes that compute a collection from the collection in their
+ * parent.  It keeps the last input, such that implementations can update the
+ * last output with only the elements that changed.
+ */
+template <typename Result, typename ParentT>
+class collection_node
+    : public inner_node<Result, zug::meta::pack<ParentT>, reader_node>
+{
+    using base_t = inner_node<Result, zug::meta::pack<ParentT>, reader_node>;
+
+public:
+    using input_t = zug::meta::value_t<ParentT>;
+
+    collection_node(Result init, std::shared_ptr<ParentT> parent)
+        : base_t{std::move(init), std::make_tuple(parent)}
+        , input_{parent->current()}
+        , input_epoch_{parent->changed_epoch()}
+    {}
+
+    void recompute() final
+    {
+        auto& parent = std::get<0>(this->parents());
+        if (parent->changed_epoch() == input_epoch_)
+            return;
+        auto& input = parent->current();
+        this->push_down(update(input_, input));
+        input_       = input;
+        input_epoch_ = parent->changed_epoch();
+    }
+
+protected:
+    virtual Result update(const input_t& old, const input_t& next) = 0;
+
+private:
+    input_t input_;
+    std::uint64_t input_epoch_;
+};
+
+template <typename ParentT, typename Fn>
+class each_node
+    : public collection_node<each_result_t<zug::meta::value_t<ParentT>, Fn>,
+                             ParentT>
+{
+    using base_t =
+        collection_node<each_result_t<zug::meta::value_t<ParentT>, Fn>,
+                        ParentT>;
+    using input_t  = typename base_t::input_t;
+    using result_t = typename base_t::value_type;
+
+    Fn fn_;
+
+public:
+    each_node(std::shared_ptr<ParentT> parent, Fn fn)
+        : base_t{init_(parent->current(), fn), parent}
+        , fn_{std::move(fn)}
+    {}
+
+protected:
+    result_t update(const input_t& old, const input_t& next) final
+    {
+        auto result = this->current();
+        if constexpr (is_immer_map_v<input_t>) {
+            auto set = [&](auto&& x) {
+                result = std::move(result).set(x.first, fn_(x.second));
+            };
+            immer::diff(old,
+                        next,
+                        immer::make_differ(
+                            set,
+                            [&](auto&& x) {
+                                result = std::move(result).erase(x.first);
+                            },
+                            [&](auto&&, auto&& x) { set(x); }));
+            return result;
+        } else {
+            auto [prefix, suffix] = common_ends(old, next);
+            auto middle           = result.take(prefix);
+            for (auto i = prefix, e = next.size() - suffix; i < e; ++i)
+                middle = std::move(middle).push_back(fn_(next[i]));
+            return std::move(middle) + result.drop(result.size() - suffix);
+        }
+    }
+
+private:
+    static result_t init_(const input_t& input, Fn& fn)
+    {
+        auto result = result_t{};
+        if constexpr (is_immer_map_v<input_t>) {
+            for (auto&& x : input)
+                result = std::move(result).set(x.first, fn(x.second));
+        } else {
+            for (auto&& x : input)
+                result = std::move(result).push_back(fn(x));
+        }
+        return result;
+    }
+};
+
+template <typename ParentT, typename Pred>
+class filter_node
+    : public collection_node<filter_result_t<zug::meta::value_t<ParentT>>,
+                             ParentT>
+{
+    using base_t =
+        collection_node<filter_result_t<zug::meta::value_t<ParentT>>,
+                        ParentT>;
+    using input_t  = typename base_t::input_t;
+    using result_t = typename base_t::value_type;
+
+    Pred pred_;
+    // for sequences, whether each element of the input was kept
+    immer::flex_vector<bool> kept_;
+
+    using init_t = std::pair<result_t, immer::flex_vector<bool>>;
+
+    filter_node(init_t init, std::shared_ptr<ParentT> parent, Pred pred)
+        : base_t{std::move(init.first), std::move(parent)}
+        , pred_{std::move(pred)}
+        , kept_{std::move(init.second)}
+    {}
+
+public:
+    filter_node(std::shared_ptr<ParentT> parent, Pred pred)
+        : filter_node{init_(parent->current(), pred), parent, std::move(pred)}
+    {}
+
+protected:
+    result_t update(const input_t& old, const input_t& next) final
+    {
+        auto result = this->current();
+        if constexpr (is_immer_map_v<input_t>) {
+            auto set = [&](auto&& x) {
+                result = pred_(x.second)
+                             ? std::move(result).set(x.first, x.second)
+                             : std::move(result).erase(x.first);
+            };
+            immer::diff(old,
+                        next,
+                        immer::make_differ(
+                            set,
+                            [&](auto&& x) {
+                                result = std::move(result).erase(x.first);
+                            },
+                            [&](auto&&, auto&& x) { set(x); }));
+            return result;
+        } else {
+            auto [prefix, suffix] = common_ends(old, next);
+            // the kept elements of one end are found from the others, so
+            // only the shorter end needs to be counted
+            auto count = [&](std::size_t first, std::size_t last) {
+                return static_cast<std::size_t>(std::count(
+                    kept_.begin() + first, kept_.begin() + last, true));
+            };
+            auto old_end     = old.size() - suffix;
+            auto kept_middle = count(prefix, old_end);
+            auto kept_prefix =
+                prefix <= suffix
+                    ? count(0, prefix)
+                    : result.size() - kept_middle - count(old_end, old.size());
+            auto kept_suffix = result.size() - kept_prefix - kept_middle;
+            auto middle      = result.take(kept_prefix);
+            auto kept        = kept_.take(prefix);
+            for (auto i = prefix, e = next.size() - suffix; i < e; ++i) {
+                auto keep = static_cast<bool>(pred_(next[i]));
+                kept      = std::move(kept).push_back(keep);
+                if (keep)
+                    middle = std::move(middle).push_back(next[i]);
+            }
+            kept_ = std::move(kept) + kept_.drop(kept_.size() - suffix);
+            return std::move(middle) + result.drop(result.size() - kept_suffix);
+        }
+    }
+
+private:
+    static init_t init_(const input_t& input, Pred& pred)
+    {
+        auto result = result_t{};
+        auto kept   = immer::flex_vector<bool>{};
+        for (auto&& x : input) {
+            if constexpr (is_immer_map_v<input_t>) {
+                if (pred(x.second))
+                    result = std::move(result).set(x.first, x.second);
+            } else {
+                auto keep = static_cast<bool>(pred(x));
+                kept      = std::move(kept).push_back(keep);
+                if (keep)
+                    result = std::move(result).push_back(x);
+            }
+        }
+        return {std::move(result), std::move(kept)};
+    }
+};
+
+template <template <class, class> class Node, typename ParentT, typename Fn>
+auto make_collection_node(std::shared_ptr<ParentT> parent, Fn&& fn)
+{
+    auto n = std::make_shared<Node<ParentT, std::decay_t<Fn>>>(
+        parent, std::forward<Fn>(fn));
+    parent->link(n);
+    return n;
+}
+
+} // namespace detail
+
+//! @defgroup cursors
+//! @{
+
+/*!
+ * Returns a reader with the result of applying `fn` to every element of the
+ * collection in the reader or cursor `r`.  The collection can be an
+ * `immer::map`, in which case `fn` is applied to the values and the result is
+ * an `immer::map` with the same keys, or a sequence like `immer::vector` or
+ * `immer::flex_vector`, in which case the result is an `immer::flex_vector`.
+ *
+ * When the collection changes, `fn` is only called for the elements that
+ * changed, and the rest of the result is shared with its previous version.
+ * For maps, the changed elements are found by diffing the collections.  For
+ * sequences, unchanged elements are found at both ends of the sequence,
+ * recognizing the elements that are structurally shared without comparing
+ * them.  With `immer` sequences, shared leaves are skipped whole, so adding
+ * or updating a few elements takes time proportional to the number of leaves
+ * in the sequence, plus the number of changed elements.
+ */
+template <typename ReaderT, typename Fn>
+auto each(ReaderT&& r, Fn&& fn)
+{
+    auto parent = detail::access::node(std::forward<ReaderT>(r).make());
+    auto node   = detail::make_collection_node<detail::each_node>(
+        std::move(parent), std::forward<Fn>(fn));
+    return reader_base<typename decltype(node)::element_type>{std::move(node)};
+}
+
+/*!
+ * Returns a reader with the elements of the collection in the reader or
+ * cursor `r` that satisfy `pred`.  The result is updated incrementally, in the
+ * same way as with `lager::each()`.  For sequences, finding where the changed
+ * elements go in the result also counts the kept elements in the shorter of
+ * the unchanged ends of the sequence.  Adding or removing elements at the
+ * ends is thus cheap, but a change in the middle of it takes linear time.
+ */
+template <typename ReaderT, typename Pred>
+auto filter_items(ReaderT&& r, Pred&& pred)
+{
+    auto parent = detail::access::node(std::forward<ReaderT>(r).make());
+    auto node   = detail::make_collection_node<detail::filter_node>(
+        std::move(parent), std::forward<Pred>(pred));
+    return reader_base<typename decltype(node)::element_type>{std::move(node)};
+}
+
+//! @}
+
+} // namespace lager
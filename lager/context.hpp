@@ -12,8 +12,10 @@
 
 #pragma once
 
+#include <lager/config.hpp>
 #include <lager/deps.hpp>
 #include <lager/future.hpp>
+#include <lager/timer.hpp>
 #include <lager/util.hpp>
 
 #include <boost/hana/all_of.hpp>
@@ -24,9 +26,16 @@
 #include <boost/hana/remove_if.hpp>
 #include <boost/hana/type.hpp>
 
+#include <zug/meta/detected.hpp>
+
+#include <chrono>
 #include <functional>
 #include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <tuple>
 #include <type_traits>
+#include <unordered_map>
 
 namespace lager {
 
@@ -146,61 +155,239 @@ template <typename Actions1, typename Actions2>
 using merge_actions_t = typename decltype(merge_actions_aux(
     as_actions_t<Actions1>::as_hana_, as_actions_t<Actions2>::as_hana_))::type;
 
+/*!
+ * Type-erased function that delivers actions of type `Action`.  The `call`
+ * function is invoked with the sink of the dispatcher and the `next` pointer
+ * of the entry itself, which is used to chain entries that convert actions.
+ */
+template <typename Action>
+struct dispatch_entry
+{
+    future (*call)(void* sink, const void* next, Action&& act);
+    const void* next;
+};
+
+/*!
+ * Table with one dispatch entry per action type.  Tables are never destroyed:
+ * they are either static or cached forever.
+ */
+template <typename Actions>
+struct dispatch_table;
+
+template <typename... Actions>
+struct dispatch_table<actions<Actions...>> : dispatch_entry<Actions>...
+{};
+
+template <typename Action, typename... As>
+const dispatch_entry<Action>& get_dispatch_entry(
+    const dispatch_table<actions<As...>>& table)
+{
+    return table;
+}
+
+template <typename Action, typename Actions>
+struct dispatched_action;
+
+template <typename Action, typename... As>
+struct dispatched_action<Action, actions<As...>>
+{
+    using type = find_convertible_action_t<Action, As...>;
+};
+
+/*!
+ * Type of the action that is actually dispatched when dispatching `Action`
+ * through a dispatcher for `Actions`.
+ */
+template <typename Action, typename Actions>
+using dispatched_action_t = typename dispatched_action<Action, Actions>::type;
+
+/*!
+ * Table that delivers actions to a sink that is an instance of `Fn`.
+ */
+template <typename Fn, typename Actions>
+struct root_dispatch_table;
+
+template <typename Fn, typename... As>
+struct root_dispatch_table<Fn, actions<As...>>
+{
+    template <typename Action>
+    static future call(void* sink, const void*, Action&& act)
+    {
+        return std::invoke(*static_cast<Fn*>(sink), std::move(act));
+    }
+
+    static constexpr dispatch_table<actions<As...>> value = {
+        dispatch_entry<As>{&call<As>, nullptr}...};
+};
+
+/*!
+ * Table used by default constructed dispatchers.
+ */
+template <typename Actions>
+struct empty_dispatch_table;
+
+template <typename... As>
+struct empty_dispatch_table<actions<As...>>
+{
+    template <typename Action>
+    static future call(void*, const void*, Action&&)
+    {
+        LAGER_THROW(std::bad_function_call{});
+    }
+
+    static constexpr dispatch_table<actions<As...>> value = {
+        dispatch_entry<As>{&call<As>, nullptr}...};
+};
+
+template <typename Action, typename... Bs>
+dispatch_entry<Action>
+derive_dispatch_entry(const dispatch_table<actions<Bs...>>& src)
+{
+    using target_t = find_convertible_action_t<Action, Bs...>;
+    auto& e        = get_dispatch_entry<target_t>(src);
+    if constexpr (std::is_same_v<Action, target_t>) {
+        return e;
+    } else {
+        return {[](void* sink, const void* next, Action&& act) {
+                    auto t = static_cast<const dispatch_entry<target_t>*>(next);
+                    return t->call(sink, t->next, target_t(std::move(act)));
+                },
+                &e};
+    }
+}
+
+template <typename... As, typename Table>
+std::unique_ptr<const dispatch_table<actions<As...>>>
+make_derived_dispatch_table(actions<As...>, const Table& src)
+{
+    return std::unique_ptr<const dispatch_table<actions<As...>>>{
+        new dispatch_table<actions<As...>>{derive_dispatch_entry<As>(src)...}};
+}
+
+/*!
+ * Returns a table for `Actions` that dispatches through the table `src` of a
+ * compatible set of actions.  Derived tables are built once per source table
+ * and cached, such that converting dispatchers does not allocate, and does not
+ * even lock when the same conversion is repeated in a thread.
+ */
+template <typename Actions, typename... Bs>
+const dispatch_table<Actions>*
+derive_dispatch_table(const dispatch_table<actions<Bs...>>* src)
+{
+    if constexpr (std::is_same_v<Actions, actions<Bs...>>) {
+        return src;
+    } else {
+        using table_t = dispatch_table<Actions>;
+        thread_local auto last_src = decltype(src){};
+        thread_local auto last     = static_cast<const table_t*>(nullptr);
+        if (src != last_src) {
+            static auto mutex = std::mutex{};
+            static auto cache = std::unordered_map<
+                const void*,
+                std::unique_ptr<const table_t>>{};
+            auto lock = std::lock_guard<std::mutex>{mutex};
+            auto& r   = cache[src];
+            if (!r)
+                r = make_derived_dispatch_table(Actions{}, *src);
+            last_src = src;
+            last     = r.get();
+        }
+        return last;
+    }
+}
+
+/*!
+ * Delivers actions of any of the types in `Actions`.  It stores a single
+ * type-erased sink, shared with the dispatchers it was converted from or to,
+ * plus a pointer to a table that converts actions to those the sink accepts.
+ * Its size is thus independent of the number of action types.
+ */
 template <typename... Actions>
 struct dispatcher;
 
 template <typename... Actions>
-struct dispatcher<actions<Actions...>> : std::function<future(Actions)>...
+struct dispatcher<actions<Actions...>>
 {
-    using std::function<future(Actions)>::operator()...;
+    using actions_t = actions<Actions...>;
+    using table_t   = dispatch_table<actions_t>;
 
     dispatcher() = default;
 
     template <typename... As>
     dispatcher(dispatcher<actions<As...>> other)
-        : std::function<future(Actions)>{static_cast<std::function<future(
-              find_convertible_action_t<Actions, As...>)>&>(other)}...
+        : sink_{std::move(other.sink_)}
+        , table_{derive_dispatch_table<actions_t>(other.table_)}
     {}
 
     template <typename Fn>
     dispatcher(Fn other)
-        : std::function<future(Actions)>{other}...
+        : sink_{std::make_shared<Fn>(std::move(other))}
+        , table_{&root_dispatch_table<Fn, actions_t>::value}
     {}
 
-    template <typename Action, typename... As, typename Converter>
-    static auto dispatcher_fn_aux(dispatcher<actions<As...>> other_,
-                                  Converter conv)
-    {
-        auto& other = static_cast<std::function<future(
-            find_convertible_action_t<std::invoke_result_t<Converter, Action>,
-                                      As...>)>&>(other_);
-        return
-            [conv, other](auto&& act) { return other(conv(LAGER_FWD(act))); };
-    }
-
     template <typename... As, typename Converter>
     dispatcher(dispatcher<actions<As...>> other, Converter conv)
-        : std::function<future(Actions)>{
-              dispatcher_fn_aux<Actions>(other, conv)}...
+        : dispatcher{[other = std::move(other), conv](auto&& act) {
+            return other(conv(LAGER_FWD(act)));
+        }}
     {}
 
     template <typename Fn, typename Converter>
     dispatcher(Fn other, Converter conv)
-        : std::function<future(Actions)>{[other, conv](auto&& act) {
+        : dispatcher{[other, conv](auto&& act) mutable {
             return other(conv(LAGER_FWD(act)));
-        }}...
+        }}
     {}
+
+    template <typename Action>
+    future operator()(Action&& act) const
+    {
+        using action_t = dispatched_action_t<std::decay_t<Action>, actions_t>;
+        auto& e        = get_dispatch_entry<action_t>(*table_);
+        return e.call(sink_.get(), e.next, action_t(std::forward<Action>(act)));
+    }
+
+    void* sink() const { return sink_.get(); }
+    const table_t* table() const { return table_; }
+
+private:
+    template <typename... As>
+    friend struct dispatcher;
+
+    std::shared_ptr<void> sink_;
+    const table_t* table_ = &empty_dispatch_table<actions_t>::value;
 };
 
 struct event_loop_iface
 {
+    using clock      = std::chrono::steady_clock;
+    using duration   = clock::duration;
+    using time_point = clock::time_point;
+
     virtual ~event_loop_iface()               = default;
+    virtual void post(std::function<void()>)  = 0;
     virtual void async(std::function<void()>) = 0;
     virtual void finish()                     = 0;
     virtual void pause()                      = 0;
     virtual void resume()                     = 0;
+
+    virtual timer_handle post_after(duration, std::function<void()>) = 0;
+    virtual timer_handle post_every(duration, std::function<void()>) = 0;
+
+    timer_handle post_at(time_point when, std::function<void()> fn)
+    {
+        return post_after(when - clock::now(), std::move(fn));
+    }
 };
 
+template <typename EventLoop>
+using post_after_t = decltype(std::declval<EventLoop&>().post_after(
+    event_loop_iface::duration{}, std::declval<std::function<void()>>()));
+
+template <typename EventLoop>
+using post_every_t = decltype(std::declval<EventLoop&>().post_every(
+    event_loop_iface::duration{}, std::declval<std::function<void()>>()));
+
 template <typename EventLoop>
 struct event_loop_impl final : event_loop_iface
 {
@@ -209,10 +396,29 @@ struct event_loop_impl final : event_loop_iface
     event_loop_impl(EventLoop& loop_)
         : loop{loop_}
     {}
+    void post(std::function<void()> fn) override { loop.post(std::move(fn)); }
     void async(std::function<void()> fn) override { loop.async(std::move(fn)); }
     void finish() override { loop.finish(); }
     void pause() override { loop.pause(); }
     void resume() override { loop.resume(); }
+
+    timer_handle post_after(duration d, std::function<void()> fn) override
+    {
+        if constexpr (zug::meta::is_detected<post_after_t, EventLoop>::value)
+            return loop.post_after(d, std::move(fn));
+        else
+            LAGER_THROW(
+                std::logic_error{"event loop does not support timers"});
+    }
+
+    timer_handle post_every(duration d, std::function<void()> fn) override
+    {
+        if constexpr (zug::meta::is_detected<post_every_t, EventLoop>::value)
+            return loop.post_every(d, std::move(fn));
+        else
+            LAGER_THROW(
+                std::logic_error{"event loop does not support timers"});
+    }
 };
 
 } // namespace detail
@@ -313,9 +519,94 @@ struct context : Deps
 private:
     template <typename A, typename Ds>
     friend struct context;
+    template <typename A, typename Ds>
+    friend struct context_ref;
 
     detail::dispatcher<actions_t> dispatcher_;
     std::shared_ptr<detail::event_loop_iface> loop_;
 };
 
+/*!
+ * Non-owning view of a `context`.  It borrows the dispatcher and event loop of
+ * the context it is created from, thus creating and converting it involves no
+ * reference counting nor allocation.  This makes it suitable for effects that
+ * are invoked very often, or that are nested in multiple levels of reducers
+ * where each level would otherwise convert the context.
+ *
+ * It follows the same contravariance rules as `context`, and effects accept
+ * functions taking a `context_ref` in place of a `context`:
+ *
+ * @rst
+ *
+ * .. code-block:: c++
+ *
+ *    lager::effect<any_action> eff =
+ *        [](lager::context_ref<actions<action_A, action_B>> ctx) {
+ *            ctx.dispatch(action_A{});
+ *        };
+ *
+ * @endrst
+ *
+ * @note The dependencies are copied, like in `context`.  Prefer declaring
+ *       them as references when the view is created often.
+ *
+ * @note This is a reference type bound to the life-time of the `context` it
+ *       was created from, and not only of the store.  Do not keep it after
+ *       the context it was obtained from is destructed, use a `context`
+ *       instead when it has to be stored, for example, in asynchronous
+ *       callbacks.
+ */
+template <typename Actions = void, typename Deps = lager::deps<>>
+struct context_ref : Deps
+{
+    using deps_t    = Deps;
+    using actions_t = as_actions_t<Actions>;
+
+    template <
+        typename Actions_,
+        typename Deps_,
+        std::enable_if_t<detail::are_compatible_actions_v<Actions, Actions_> &&
+                             std::is_convertible_v<Deps_, Deps>,
+                         int> = 0>
+    context_ref(const context<Actions_, Deps_>& ctx)
+        : deps_t{ctx}
+        , sink_{ctx.dispatcher_.sink()}
+        , table_{detail::derive_dispatch_table<actions_t>(
+              ctx.dispatcher_.table())}
+        , loop_{ctx.loop_.get()}
+    {}
+
+    template <
+        typename Actions_,
+        typename Deps_,
+        std::enable_if_t<detail::are_compatible_actions_v<Actions, Actions_> &&
+                             std::is_convertible_v<Deps_, Deps>,
+                         int> = 0>
+    context_ref(const context_ref<Actions_, Deps_>& ctx)
+        : deps_t{ctx}
+        , sink_{ctx.sink_}
+        , table_{detail::derive_dispatch_table<actions_t>(ctx.table_)}
+        , loop_{ctx.loop_}
+    {}
+
+    template <typename Action>
+    future dispatch(Action&& act) const
+    {
+        using action_t =
+            detail::dispatched_action_t<std::decay_t<Action>, actions_t>;
+        auto& e = detail::get_dispatch_entry<action_t>(*table_);
+        return e.call(sink_, e.next, action_t(std::forward<Action>(act)));
+    }
+
+    detail::event_loop_iface& loop() const { return *loop_; }
+
+private:
+    template <typename A, typename Ds>
+    friend struct context_ref;
+
+    void* sink_;
+    const detail::dispatch_table<actions_t>* table_;
+    detail::event_loop_iface* loop_;
+};
+
 } // namespace lager
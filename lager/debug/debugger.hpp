@@ -18,8 +18,10 @@
 #include <lager/util.hpp>
 
 #include <immer/algorithm.hpp>
+#include <immer/flex_vector.hpp>
 #include <immer/vector.hpp>
 
+#include <lager/extra/cereal/immer_flex_vector.hpp>
 #include <lager/extra/cereal/immer_vector.hpp>
 #include <lager/extra/cereal/struct.hpp>
 #include <lager/extra/cereal/variant_with_name.hpp>
@@ -27,11 +29,30 @@
 
 #include <zug/transducer/map.hpp>
 
+#include <cereal/types/optional.hpp>
+
 #include <functional>
+#include <memory>
+#include <optional>
 #include <variant>
 
 namespace lager {
 
+/*!
+ * Limits on the history kept by a debugger, such that its memory use stays
+ * flat no matter how long the session runs.  A zero means no limit.
+ */
+struct debugger_limits
+{
+    //! Maximum number of steps kept, the oldest ones are dropped.
+    std::size_t max_steps = 0;
+    //! Number of most recent steps that keep their model.  Older steps only
+    //! keep it every `checkpoint_interval` steps, and the models in between
+    //! are recomputed by replaying the actions from the previous checkpoint.
+    std::size_t max_models          = 0;
+    std::size_t checkpoint_interval = 16;
+};
+
 template <typename Action, typename Model, typename Deps>
 struct debugger
 {
@@ -73,39 +94,105 @@ struct debugger
     struct step
     {
         Action action;
-        Model model;
+        //! Empty when the step was thinned out of the history
+        std::optional<Model> model;
         LAGER_STRUCT_NESTED(step, action, model);
     };
 
+    using replay_fn = std::function<Model(Model, const Action&)>;
+
     struct model
     {
         cursor_t cursor = {};
         bool paused     = {};
         Model init;
-        immer::vector<step> history   = {};
-        immer::vector<Action> pending = {};
+        immer::flex_vector<step> history = {};
+        immer::vector<Action> pending    = {};
         LAGER_STRUCT_NESTED(model, cursor, paused, init, history, pending);
 
+        debugger_limits limits = {};
+        //! Number of steps dropped from the front of the history
+        std::size_t dropped = 0;
+        //! Model at the cursor, when its step does not keep it
+        std::optional<Model> replayed = std::nullopt;
+        //! Recomputes a model from the previous one, without effects
+        std::shared_ptr<const replay_fn> replay = {};
+
         model() = default;
-        model(Model i)
+        model(Model i, debugger_limits l = {})
             : init{i}
+            , limits{l}
         {}
 
-        using lookup_result = std::pair<std::optional<Action>, const Model&>;
+        using lookup_result = std::pair<std::optional<Action>, Model>;
 
         lookup_result lookup(cursor_t cursor) const
         {
             if (cursor > history.size())
                 LAGER_THROW(std::runtime_error{"bad cursor"});
-            return cursor == 0 ? lookup_result{{}, init} : [&] {
-                auto& step = history[cursor - 1];
-                return lookup_result{step.action, step.model};
-            }();
+            return cursor == 0
+                       ? lookup_result{{}, init}
+                       : lookup_result{history[cursor - 1].action,
+                                       model_at(cursor)};
         }
 
         std::size_t summary() const { return history.size(); }
 
-        operator const Model&() const { return lookup(cursor).second; }
+        operator const Model&() const
+        {
+            if (cursor == 0)
+                return init;
+            auto& step = history[cursor - 1];
+            return step.model ? *step.model : *replayed;
+        }
+
+        /*!
+         * Returns the model after the step at `cursor`, replaying the actions
+         * from the closest previous step that kept its model if necessary.
+         */
+        Model model_at(cursor_t cursor) const
+        {
+            auto pos = cursor;
+            while (pos > 0 && !history[pos - 1].model)
+                --pos;
+            auto result = pos == 0 ? init : *history[pos - 1].model;
+            for (; pos < cursor; ++pos)
+                result = (*replay)(std::move(result), history[pos].action);
+            return result;
+        }
+
+        void seek(cursor_t pos)
+        {
+            cursor   = pos;
+            replayed = pos == 0 || history[pos - 1].model
+                           ? std::nullopt
+                           : std::optional<Model>{model_at(pos)};
+        }
+
+        /*!
+         * Enforces the `limits` after a step was added at the end of the
+         * history.
+         */
+        void compact()
+        {
+            auto interval = limits.checkpoint_interval;
+            if (limits.max_models && interval > 1 &&
+                history.size() > limits.max_models) {
+                auto pos = history.size() - limits.max_models - 1;
+                if ((dropped + pos + 1) % interval != 0 && history[pos].model)
+                    history = history.update(pos, [](auto s) {
+                        s.model.reset();
+                        return s;
+                    });
+            }
+            if (limits.max_steps && history.size() > limits.max_steps) {
+                auto count = history.size() - limits.max_steps;
+                init       = model_at(count);
+                history    = history.drop(count);
+                dropped += count;
+                seek(cursor > count ? cursor - count : 0);
+            }
+        }
 
         friend decltype(auto) unwrap(const model& m)
         {
@@ -125,32 +212,43 @@ struct debugger
                         m.pending = m.pending.push_back(act);
                         return {m, noop};
                     } else {
+                        if (!m.replay)
+                            m.replay = std::make_shared<const replay_fn>(
+                                [reducer](Model model, const Action& act) {
+                                    return invoke_reducer<deps_t>(
+                                        reducer,
+                                        std::move(model),
+                                        act,
+                                        [](auto&&) {},
+                                        [] {});
+                                });
                         auto eff   = effect<action, deps_t>{noop};
                         auto state = invoke_reducer<deps_t>(
                             reducer,
-                            m,
+                            static_cast<const Model&>(m),
                             act,
                             [&](auto&& e) { eff = LAGER_FWD(e); },
                             [] {});
                         m.history = m.history.take(m.cursor).push_back(
                             {act, std::move(state)});
-                        m.cursor = m.history.size();
+                        m.seek(m.history.size());
+                        m.compact();
                         return {m, eff};
                     }
                 },
                 [&](goto_action act) -> result_t {
                     if (act.cursor <= m.history.size())
-                        m.cursor = act.cursor;
+                        m.seek(act.cursor);
                     return {m, noop};
                 },
                 [&](undo_action) -> result_t {
                     if (m.cursor > 0)
-                        --m.cursor;
+                        m.seek(m.cursor - 1);
                     return {m, noop};
                 },
                 [&](redo_action) -> result_t {
                     if ((m.cursor) < m.history.size())
-                        ++m.cursor;
+                        m.seek(m.cursor + 1);
                     return {m, noop};
                 },
                 [&](pause_action) -> result_t {
@@ -186,17 +284,23 @@ struct debugger
     }
 };
 
+/*!
+ * Store enhancer that connects the store to the debugger server `serv`.  The
+ * extra `args` are passed to the constructor of the debugger model, after the
+ * initial model.  For example, `lager::debugger` takes `debugger_limits`.
+ */
 template <template <class, class, class> class Debugger = debugger,
-          typename Server>
-auto with_debugger(Server& serv)
+          typename Server,
+          typename... Args>
+auto with_debugger(Server& serv, Args... args)
 {
-    return [&](auto next) {
-        return [&serv, next](auto action,
-                             auto&& model,
-                             auto&& reducer,
-                             auto&& loop,
-                             auto&& deps,
-                             auto&& tags) {
+    return [&serv, args...](auto next) {
+        return [&serv, next, args...](auto action,
+                                       auto&& model,
+                                       auto&& reducer,
+                                       auto&& loop,
+                                       auto&& deps,
+                                       auto&& tags) {
             using action_t   = typename decltype(action)::type;
             using model_t    = std::decay_t<decltype(model)>;
             using deps_t     = std::decay_t<decltype(deps)>;
@@ -204,7 +308,7 @@ auto with_debugger(Server& serv)
             auto handle      = serv.make(debugger_t{});
             auto store       = next(
                 type_<typename debugger_t::action>{},
-                typename debugger_t::model{LAGER_FWD(model)},
+                typename debugger_t::model{LAGER_FWD(model), args...},
                 [reducer = LAGER_FWD(reducer)](auto&& model, auto&& action) {
                     return debugger_t::update(
                         reducer, LAGER_FWD(model), LAGER_FWD(action));
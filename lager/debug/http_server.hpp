@@ -19,21 +19,37 @@
 #include <cereal/archives/json.hpp>
 #include <cereal/cereal.hpp>
 #include <cereal/types/optional.hpp>
+#include <lager/extra/cereal/diff.hpp>
+#include <lager/extra/cereal/structural_sharing.hpp>
 #include <lager/extra/cereal/variant_with_name.hpp>
 
 #include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/post.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <boost/asio/strand.hpp>
+#include <boost/asio/thread_pool.hpp>
+#include <boost/asio/write.hpp>
 #include <boost/beast/core.hpp>
 #include <boost/beast/http.hpp>
 
 #include <immer/atom.hpp>
 
+#include <algorithm>
+#include <array>
 #include <atomic>
+#include <charconv>
+#include <chrono>
 #include <fstream>
 #include <functional>
+#include <map>
 #include <memory>
-#include <regex>
+#include <optional>
 #include <sstream>
+#include <string_view>
 #include <thread>
+#include <tuple>
+#include <utility>
+#include <variant>
 #include <vector>
 
 namespace lager {
@@ -43,46 +59,312 @@ namespace asio  = boost::asio;
 
 namespace detail::http {
 
+/*!
+ * Pushes Server-Sent Events through a connection.  Every frame it polls for
+ * the event to send, if any, so whatever happened during the frame is sent
+ * as a single event.  Frames are skipped while the previous event is still
+ * being written, so a slow client gets fewer, bigger events instead of
+ * falling behind.  Polling happens in the `workers`, since it usually
+ * serializes some data.  The stream stops when the client closes the
+ * connection.
+ */
+class event_stream : public std::enable_shared_from_this<event_stream>
+{
+public:
+    struct event
+    {
+        std::string name;
+        std::string data;
+    };
+
+    using poll_t = std::function<std::optional<event>()>;
+
+    static constexpr auto default_frame = std::chrono::milliseconds{16};
+
+    event_stream(asio::ip::tcp::socket&& socket,
+                 asio::thread_pool& workers,
+                 poll_t poll,
+                 std::chrono::steady_clock::duration frame = default_frame)
+        : socket_{std::move(socket)}
+        , timer_{socket_.get_executor()}
+        , workers_{workers}
+        , poll_{std::move(poll)}
+        , frame_{frame}
+    {
+        header_.result(beast::http::status::ok);
+        header_.set(beast::http::field::content_type, "text/event-stream");
+        header_.set(beast::http::field::cache_control, "no-cache");
+        header_.keep_alive(true);
+    }
+
+    void run()
+    {
+        do_read_();
+        beast::http::async_write_header(socket_,
+                                        serializer_,
+                                        std::bind(&event_stream::on_write_,
+                                                  shared_from_this(),
+                                                  std::placeholders::_1,
+                                                  std::placeholders::_2));
+    }
+
+private:
+    // The client does not send anything after the request, but reading is
+    // the only way to find out that it went away while nothing is written.
+    void do_read_()
+    {
+        socket_.async_read_some(asio::buffer(read_buffer_),
+                                std::bind(&event_stream::on_read_,
+                                          shared_from_this(),
+                                          std::placeholders::_1,
+                                          std::placeholders::_2));
+    }
+
+    void on_read_(beast::error_code ec, std::size_t)
+    {
+        if (ec)
+            return do_close_();
+        do_read_();
+    }
+
+    void do_wait_()
+    {
+        if (closed_)
+            return;
+        timer_.expires_after(frame_);
+        timer_.async_wait(std::bind(&event_stream::on_frame_,
+                                    shared_from_this(),
+                                    std::placeholders::_1));
+    }
+
+    void on_frame_(beast::error_code ec)
+    {
+        if (ec)
+            return do_close_();
+        asio::post(workers_, [self = shared_from_this()] {
+            auto ev = std::optional<event>{};
+            auto ok = true;
+            LAGER_TRY {
+                ev = self->poll_();
+            } LAGER_CATCH(const std::exception&) {
+                ok = false;
+            }
+            asio::post(self->socket_.get_executor(),
+                       [self, ok, ev = std::move(ev)]() mutable {
+                           if (!ok)
+                               return self->do_close_();
+                           self->on_poll_(std::move(ev));
+                       });
+        });
+    }
+
+    void on_poll_(std::optional<event> ev)
+    {
+        if (closed_)
+            return;
+        if (!ev)
+            return do_wait_();
+        // every line of the data needs its own field, see:
+        // https://html.spec.whatwg.org/multipage/server-sent-events.html
+        buffer_ = "event: " + ev->name + "\n";
+        for (auto pos = std::size_t{}; pos <= ev->data.size();) {
+            auto end = std::min(ev->data.find('\n', pos), ev->data.size());
+            buffer_ += "data: ";
+            buffer_.append(ev->data, pos, end - pos);
+            buffer_ += "\n";
+            pos = end + 1;
+        }
+        buffer_ += "\n";
+        asio::async_write(socket_,
+                          asio::buffer(buffer_),
+                          std::bind(&event_stream::on_write_,
+                                    shared_from_this(),
+                                    std::placeholders::_1,
+                                    std::placeholders::_2));
+    }
+
+    void on_write_(beast::error_code ec, std::size_t)
+    {
+        if (ec)
+            return do_close_();
+        do_wait_();
+    }
+
+    void do_close_()
+    {
+        if (std::exchange(closed_, true))
+            return;
+        timer_.cancel();
+        beast::error_code ec;
+        socket_.shutdown(asio::ip::tcp::socket::shutdown_both, ec);
+        socket_.close(ec);
+    }
+
+    asio::ip::tcp::socket socket_;
+    asio::steady_timer timer_;
+    asio::thread_pool& workers_;
+    poll_t poll_;
+    std::chrono::steady_clock::duration frame_;
+    beast::http::response<beast::http::empty_body> header_;
+    beast::http::response_serializer<beast::http::empty_body> serializer_{
+        header_};
+    std::string buffer_;
+    std::array<char, 256> read_buffer_;
+    bool closed_ = false;
+};
+
+/*!
+ * Parameters extracted from the target of a request by the `router`.
+ */
+class params
+{
+public:
+    using value_t = std::variant<std::string, std::uint64_t>;
+
+    /*!
+     * Returns the parameter called `name`, which is an integer for
+     * `{name:uint}` segments and a `std::string` otherwise.
+     */
+    template <typename T>
+    T get(std::string_view name) const
+    {
+        auto it = std::find_if(values_.begin(),
+                               values_.end(),
+                               [&](auto& v) { return v.first == name; });
+        if (it == values_.end())
+            LAGER_THROW(std::out_of_range{"no parameter: " +
+                                          std::string{name}});
+        if constexpr (std::is_integral_v<T>)
+            return static_cast<T>(std::get<std::uint64_t>(it->second));
+        else
+            return std::get<std::string>(it->second);
+    }
+
+    void push(std::string_view name, value_t value)
+    {
+        values_.emplace_back(std::string{name}, std::move(value));
+    }
+
+    void pop() { values_.pop_back(); }
+
+private:
+    std::vector<std::pair<std::string, value_t>> values_;
+};
+
+/*!
+ * Dispatches requests to the handlers of the resources that match their
+ * method and target.  Targets are patterns made of segments separated by
+ * `/`, that are either literal, or parameters:
+ *
+ * - `{name}` matches any segment.
+ * - `{name:uint}` matches a segment made of digits, extracted as an integer.
+ * - `{name*}` matches the rest of the target, which may be empty.
+ *
+ * The patterns are compiled into a trie of segments, so finding the resource
+ * for a request only looks at the routes that share its prefix.  Literal
+ * segments are preferred over parameters, and parameters are tried in the
+ * order in which their routes were added.  Empty segments and the query
+ * string are ignored.
+ */
 class router
 {
 public:
     using req_t     = beast::http::request<beast::http::string_body>;
     using res_t     = beast::http::response<beast::http::string_body>;
-    using handler_t = std::function<res_t(req_t&&)>;
+    using handler_t = std::function<res_t(req_t&&, const params&)>;
+    using stream_t =
+        std::function<event_stream::poll_t(const req_t&, const params&)>;
 
 private:
     struct resource_t
     {
         beast::http::verb method;
-        std::regex target;
         handler_t handler;
+        stream_t stream;
     };
 
-    std::vector<resource_t> resources_;
+    enum class kind_t
+    {
+        string,
+        uint,
+        rest
+    };
+
+    struct node_t;
+
+    struct param_t
+    {
+        std::string name;
+        kind_t kind;
+        std::unique_ptr<node_t> node;
+    };
+
+    struct node_t
+    {
+        std::map<std::string, std::unique_ptr<node_t>, std::less<>> literals;
+        std::vector<param_t> params;
+        std::vector<resource_t> resources;
+    };
+
+    std::unique_ptr<node_t> root_ = std::make_unique<node_t>();
 
 public:
+    /*!
+     * Result of looking up the resource for a request.
+     */
+    struct match_t
+    {
+        const resource_t* resource = nullptr;
+        http::params params;
+
+        bool is_stream() const { return resource && resource->stream; }
+    };
+
     router& route(beast::http::verb method,
-                  const std::string& target,
+                  std::string_view target,
                   handler_t handler)
     {
-        resources_.push_back({method, std::regex{target}, std::move(handler)});
+        add_(target)->resources.push_back({method, std::move(handler), {}});
         return *this;
     }
 
-    res_t handle_request(req_t&& req)
+    /*!
+     * Adds a resource that keeps the connection open to push events to the
+     * client.  The `stream` is called once per connection and returns the
+     * function that is polled every frame for the event to send.
+     */
+    router& stream(beast::http::verb method,
+                   std::string_view target,
+                   stream_t stream)
     {
-        auto it = std::find_if(resources_.begin(),
-                               resources_.end(),
-                               [&](const resource_t& resource) {
-                                   return resource.method == req.method() &&
-                                          std::regex_match(req.target().begin(),
-                                                           req.target().end(),
-                                                           resource.target);
-                               });
+        add_(target)->resources.push_back({method, {}, std::move(stream)});
+        return *this;
+    }
+
+    match_t match(const req_t& req) const
+    {
+        auto path = std::string_view{req.target().data(), req.target().size()};
+        path      = path.substr(0, path.find('?'));
+        auto result = match_t{};
+        result.resource =
+            match_(*root_, req.method(), path, 0, result.params);
+        return result;
+    }
 
-        if (it != resources_.end()) {
+    /*!
+     * Returns the function to poll for events of a stream.
+     */
+    event_stream::poll_t handle_stream(const req_t& req,
+                                       const match_t& m) const
+    {
+        return m.resource->stream(req, m.params);
+    }
+
+    res_t handle_request(req_t&& req, const match_t& m) const
+    {
+        if (m.resource && m.resource->handler) {
             LAGER_TRY {
-                return it->handler(std::move(req));
+                return m.resource->handler(std::move(req), m.params);
             } LAGER_CATCH(const std::exception& err) {
                 return create_response_(500, "text/html", err.what());
             }
@@ -92,6 +374,111 @@ public:
     }
 
 private:
+    static std::pair<std::string_view, std::size_t>
+    next_segment_(std::string_view path, std::size_t pos)
+    {
+        while (pos < path.size() && path[pos] == '/')
+            ++pos;
+        auto end = std::min(path.find('/', pos), path.size());
+        return {path.substr(pos, end - pos), end};
+    }
+
+    node_t* add_(std::string_view target)
+    {
+        auto node = root_.get();
+        for (auto [seg, pos] = next_segment_(target, 0); !seg.empty();
+             std::tie(seg, pos) = next_segment_(target, pos)) {
+            if (seg.front() != '{' || seg.back() != '}') {
+                auto it = node->literals.find(seg);
+                if (it == node->literals.end())
+                    it = node->literals
+                             .emplace(std::string{seg},
+                                      std::make_unique<node_t>())
+                             .first;
+                node = it->second.get();
+                continue;
+            }
+            auto name = seg.substr(1, seg.size() - 2);
+            auto kind = kind_t::string;
+            if (name.size() > 5 &&
+                name.substr(name.size() - 5) == std::string_view{":uint"}) {
+                name = name.substr(0, name.size() - 5);
+                kind = kind_t::uint;
+            } else if (!name.empty() && name.back() == '*') {
+                name = name.substr(0, name.size() - 1);
+                kind = kind_t::rest;
+            }
+            auto it = std::find_if(
+                node->params.begin(), node->params.end(), [&](auto& p) {
+                    return p.name == name && p.kind == kind;
+                });
+            if (it == node->params.end()) {
+                node->params.push_back(
+                    {std::string{name}, kind, std::make_unique<node_t>()});
+                it = std::prev(node->params.end());
+            }
+            node = it->node.get();
+        }
+        return node;
+    }
+
+    static const resource_t* find_resource_(const node_t& node,
+                                            beast::http::verb method)
+    {
+        auto it = std::find_if(
+            node.resources.begin(), node.resources.end(), [&](auto& r) {
+                return r.method == method;
+            });
+        return it != node.resources.end() ? &*it : nullptr;
+    }
+
+    static const resource_t* match_(const node_t& node,
+                                    beast::http::verb method,
+                                    std::string_view path,
+                                    std::size_t pos,
+                                    params& ps)
+    {
+        auto [seg, end] = next_segment_(path, pos);
+        if (seg.empty()) {
+            if (auto r = find_resource_(node, method))
+                return r;
+        } else {
+            auto it = node.literals.find(seg);
+            if (it != node.literals.end())
+                if (auto r = match_(*it->second, method, path, end, ps))
+                    return r;
+        }
+        for (auto& p : node.params) {
+            if (p.kind == kind_t::rest) {
+                auto rest = path.substr(
+                    std::min(path.find_first_not_of('/', pos), path.size()));
+                if (auto r = find_resource_(*p.node, method)) {
+                    ps.push(p.name, std::string{rest});
+                    return r;
+                }
+                continue;
+            }
+            if (seg.empty())
+                continue;
+            auto value = params::value_t{};
+            if (p.kind == kind_t::uint) {
+                auto n   = std::uint64_t{};
+                auto last = seg.data() + seg.size();
+                auto res  = std::from_chars(seg.data(), last, n);
+                if (res.ec != std::errc{} || res.ptr != last)
+                    continue;
+                value = n;
+            } else {
+                value = std::string{seg};
+            }
+            ps.push(p.name, std::move(value));
+            if (auto r = match_(*p.node, method, path, end, ps))
+                return r;
+            ps.pop();
+        }
+        return nullptr;
+    }
+
     static res_t create_response_(unsigned status_code,
                                   beast::string_view content_type,
                                   std::string body)
@@ -105,17 +492,26 @@ private:
     }
 };
 
+/*!
+ * Reads requests from a connection and writes their responses.  The handlers
+ * run in the `workers`, so the io threads are free to serve other
+ * connections while a big response is being produced.
+ */
 class session : public std::enable_shared_from_this<session>
 {
-    router& router_;
+    const router& router_;
+    asio::thread_pool& workers_;
     asio::ip::tcp::socket socket_;
     beast::flat_buffer buffer_;
     beast::http::request<beast::http::string_body> req_;
     beast::http::response<beast::http::string_body> res_;
 
 public:
-    session(router& router, asio::ip::tcp::socket&& socket)
+    session(const router& router,
+            asio::thread_pool& workers,
+            asio::ip::tcp::socket&& socket)
         : router_{router}
+        , workers_{workers}
         , socket_(std::move(socket))
     {}
 
@@ -139,8 +535,27 @@ private:
     {
         if (ec)
             return do_close_();
-        // keep response alive during the write operation
-        res_ = router_.handle_request(std::move(req_));
+        auto match = router_.match(req_);
+        // streams take over the connection
+        if (match.is_stream()) {
+            std::make_shared<event_stream>(std::move(socket_),
+                                           workers_,
+                                           router_.handle_stream(req_, match))
+                ->run();
+            return;
+        }
+        asio::post(workers_,
+                   [self = shared_from_this(), match = std::move(match)] {
+                       // keep response alive during the write operation
+                       self->res_ = self->router_.handle_request(
+                           std::move(self->req_), match);
+                       asio::post(self->socket_.get_executor(),
+                                  std::bind(&session::do_write_, self));
+                   });
+    }
+
+    void do_write_()
+    {
         beast::http::async_write(socket_,
                                  res_,
                                  std::bind(&session::on_write_,
@@ -166,15 +581,20 @@ private:
 
 class listener : public std::enable_shared_from_this<listener>
 {
-    router& router_;
+    const router& router_;
+    asio::io_context& ioc_;
+    asio::thread_pool& workers_;
     asio::ip::tcp::acceptor acceptor_;
 
 public:
-    listener(router& router,
+    listener(const router& router,
              asio::io_context& ioc,
+             asio::thread_pool& workers,
              const asio::ip::tcp::endpoint& endpoint)
         : router_{router}
-        , acceptor_{ioc}
+        , ioc_{ioc}
+        , workers_{workers}
+        , acceptor_{asio::make_strand(ioc)}
     {
         acceptor_.open(endpoint.protocol());
         acceptor_.set_option(asio::socket_base::reuse_address(true));
@@ -187,7 +607,10 @@ public:
 private:
     void do_accept_()
     {
-        acceptor_.async_accept(std::bind(&listener::on_accept_,
+        // every connection gets its own strand, so its handlers never run
+        // concurrently, even when there are multiple io threads
+        acceptor_.async_accept(asio::make_strand(ioc_),
+                               std::bind(&listener::on_accept_,
                                          shared_from_this(),
                                          std::placeholders::_1,
                                          std::placeholders::_2));
@@ -196,7 +619,8 @@ private:
     void on_accept_(boost::system::error_code ec, asio::ip::tcp::socket socket)
     {
         if (!ec) {
-            std::make_shared<session>(router_, std::move(socket))->run();
+            std::make_shared<session>(router_, workers_, std::move(socket))
+                ->run();
             do_accept_();
         }
     }
@@ -206,31 +630,56 @@ class server
 {
     router router_;
     asio::io_context io_context_;
+    asio::thread_pool workers_;
     std::shared_ptr<listener> listener_;
-    std::thread thread_;
+    std::vector<std::thread> threads_;
 
 public:
-    server(uint16_t port, router router)
+    server(uint16_t port,
+           router router,
+           std::size_t io_threads     = 1,
+           std::size_t worker_threads = 1)
         : router_{std::move(router)}
+        , io_context_{static_cast<int>(std::max(io_threads, std::size_t{1}))}
+        , workers_{std::max(worker_threads, std::size_t{1})}
         , listener_{std::make_shared<listener>(
               router_,
               io_context_,
+              workers_,
               asio::ip::tcp::endpoint{asio::ip::tcp::v4(), port})}
     {
         listener_->run();
-        thread_ = std::thread{[&] { io_context_.run(); }};
+        for (auto i = std::size_t{}; i < std::max(io_threads, std::size_t{1});
+             ++i)
+            threads_.emplace_back([&] { io_context_.run(); });
     }
 
     ~server()
     {
         io_context_.stop();
-        if (thread_.joinable())
-            thread_.join();
+        for (auto& t : threads_)
+            if (t.joinable())
+                t.join();
+        workers_.stop();
+        workers_.join();
     }
 };
 
 } // namespace detail::http
 
+/*!
+ * Threads used by a `http_debug_server`.
+ */
+struct http_debug_server_options
+{
+    //! Threads doing the network io.
+    std::size_t io_threads = 1;
+    //! Threads running the handlers of the requests, that is, serializing the
+    //! responses.  With more than one, a big response does not stall the
+    //! rest of the requests.
+    std::size_t worker_threads = 2;
+};
+
 namespace detail {
 
 template <typename Debugger>
@@ -242,14 +691,17 @@ struct http_debug_server_impl
     using model       = typename Debugger::model;
     using context_t   = context<action>;
     using reader_t    = reader<model>;
+    using params_t    = detail::http::params;
 
     http_debug_server_impl(int argc,
                            const char** argv,
                            std::uint16_t port,
-                           std::string resources_path)
+                           std::string resources_path,
+                           http_debug_server_options options = {})
         : program_{join_args_(argc, argv)}
         , port_{port}
         , resources_path_(std::move(resources_path))
+        , options_{options}
     {
         data_.watch([this](auto&& v) { model_ = LAGER_FWD(v); });
     }
@@ -263,8 +715,8 @@ struct http_debug_server_impl
         auto router = detail::http::router{};
         router
             .route(beast::http::verb::get,
-                   "/api/?",
-                   [this](auto&& req) {
+                   "/api",
+                   [this](auto&&, auto&&) {
                        auto m = model_.load();
                        auto s = std::ostringstream{};
                        {
@@ -279,14 +731,12 @@ struct http_debug_server_impl
                    })
 
             .route(beast::http::verb::get,
-                   "/api/step/[0-9]+",
-                   [this](auto&& req) {
+                   "/api/step/{cursor:uint}",
+                   [this](auto&&, const params_t& ps) {
                        auto m = model_.load();
                        auto s = std::ostringstream{};
                        {
-                           auto target = req.target().to_string();
-                           auto cursor =
-                               std::stoul(target.substr(target.rfind('/') + 1));
+                           auto cursor = ps.get<std::size_t>("cursor");
                            auto result = m->lookup(cursor);
                            auto a      = cereal::JSONOutputArchive{s};
                            if (result.first)
@@ -297,12 +747,47 @@ struct http_debug_server_impl
                            200, "application/json", s.str());
                    })
 
+            .route(beast::http::verb::get,
+                   "/api/history",
+                   [this](auto&&, auto&&) {
+                       auto m       = model_.load();
+                       auto s       = std::ostringstream{};
+                       auto sharing = structural_sharing{};
+                       {
+                           auto a = sharing_archive<cereal::JSONOutputArchive>{
+                               sharing, s};
+                           a(cereal::make_nvp("program", program_),
+                             cereal::make_nvp("history", *m));
+                       }
+                       return create_response_(
+                           200, "application/json", s.str());
+                   })
+
+            .route(beast::http::verb::get,
+                   "/api/diff/{from:uint}/{to:uint}",
+                   [this](auto&&, const params_t& ps) {
+                       auto m = model_.load();
+                       auto s = std::ostringstream{};
+                       {
+                           auto from = ps.get<std::size_t>("from");
+                           auto to   = ps.get<std::size_t>("to");
+                           auto old  = m->lookup(from).second;
+                           auto next = m->lookup(to).second;
+                           auto a    = cereal::JSONOutputArchive{s};
+                           a(cereal::make_nvp("diff", make_diff(old, next)));
+                       }
+                       return create_response_(
+                           200, "application/json", s.str());
+                   })
+
+            .stream(beast::http::verb::get,
+                    "/api/stream",
+                    [this](auto&&, auto&&) { return make_stream_poll_(); })
+
             .route(beast::http::verb::post,
-                   "/api/goto/[0-9]+",
-                   [this](auto&& req) {
-                       auto target = req.target().to_string();
-                       auto cursor =
-                           std::stoul(target.substr(target.rfind('/') + 1));
+                   "/api/goto/{cursor:uint}",
+                   [this](auto&&, const params_t& ps) {
+                       auto cursor = ps.get<std::size_t>("cursor");
                        context_.dispatch(
                            typename Debugger::goto_action{cursor});
                        return create_response_(200, "text/html", "");
@@ -310,50 +795,60 @@ struct http_debug_server_impl
 
             .route(beast::http::verb::post,
                    "/api/undo",
-                   [this](auto&&) {
+                   [this](auto&&, auto&&) {
                        context_.dispatch(typename Debugger::undo_action{});
                        return create_response_(200, "text/html", "");
                    })
 
             .route(beast::http::verb::post,
                    "/api/redo",
-                   [this](auto&&) {
+                   [this](auto&&, auto&&) {
                        context_.dispatch(typename Debugger::redo_action{});
                        return create_response_(200, "text/html", "");
                    })
 
             .route(beast::http::verb::post,
                    "/api/pause",
-                   [this](auto&&) {
+                   [this](auto&&, auto&&) {
                        context_.dispatch(typename Debugger::pause_action{});
                        return create_response_(200, "text/html", "");
                    })
 
             .route(beast::http::verb::post,
                    "/api/resume",
-                   [this](auto&&) {
+                   [this](auto&&, auto&&) {
                        context_.dispatch(typename Debugger::resume_action{});
                        return create_response_(200, "text/html", "");
                    })
 
-            .route(beast::http::verb::get, "/?.*", [this](auto&& req) {
-                auto req_path = req.target().to_string();
-                auto rel_path =
-                    req_path == "/" ? "/gui/index.html" : "/gui/" + req_path;
-                auto full_path = resources_path() + rel_path;
-                auto ifs       = std::ifstream{full_path};
-                if (!ifs.is_open())
-                    return create_response_(404, "text/html", "Not found");
-                // The whole file content is read synchronously into string,
-                // this shouldn't be a performance issue because it's used only
-                // in gui startup and has no blocking effect on the application
-                // because http::server has its own thread.
-                using it_t = std::istreambuf_iterator<char>;
-                return create_response_(
-                    200, mime_type_(full_path), std::string{it_t(ifs), it_t()});
-            });
-
-        server_.emplace(port_, std::move(router));
+            .route(beast::http::verb::get,
+                   "/{path*}",
+                   [this](auto&&, const params_t& ps) {
+                       auto req_path = ps.get<std::string>("path");
+                       auto rel_path = req_path.empty()
+                                           ? "/gui/index.html"
+                                           : "/gui/" + req_path;
+                       auto full_path = resources_path() + rel_path;
+                       auto ifs       = std::ifstream{full_path};
+                       if (!ifs.is_open())
+                           return create_response_(
+                               404, "text/html", "Not found");
+                       // The whole file content is read synchronously into
+                       // string, this shouldn't be a performance issue
+                       // because it's used only in gui startup and has no
+                       // blocking effect on the application because
+                       // http::server runs handlers in its own threads.
+                       using it_t = std::istreambuf_iterator<char>;
+                       return create_response_(
+                           200,
+                           mime_type_(full_path),
+                           std::string{it_t(ifs), it_t()});
+                   });
+
+        server_.emplace(port_,
+                        std::move(router),
+                        options_.io_threads,
+                        options_.worker_threads);
     }
 
     std::string const& resources_path() const { return resources_path_; }
@@ -362,11 +857,49 @@ private:
     std::string program_                        = {};
     std::uint16_t port_                         = {};
     std::string resources_path_                 = {};
+    http_debug_server_options options_          = {};
     context_t context_                          = {};
     reader_t data_                              = {};
     immer::atom<model> model_                   = {};
     std::optional<detail::http::server> server_ = {std::nullopt};
 
+    /*!
+     * Returns the function that polls for the events of a `/api/stream`
+     * connection.  The first event is the same status returned by `/api/`,
+     * then each frame in which the model changed sends only a patch of the
+     * summary, together with the current cursor and pause state.  The patch
+     * applies to the JSON of the summary as of the previous event, that is,
+     * the `summary` of the first event with all the patches since applied.
+     */
+    detail::http::event_stream::poll_t make_stream_poll_()
+    {
+        using event_t = detail::http::event_stream::event;
+        return [this, last = decltype(model_.load()){}, first = true]() mutable
+               -> std::optional<event_t> {
+            auto m = model_.load();
+            if (!first && &m.get() == &last.get())
+                return std::nullopt;
+            auto s = std::ostringstream{};
+            {
+                auto a = cereal::JSONOutputArchive{s};
+                if (first) {
+                    a(cereal::make_nvp("program", program_),
+                      cereal::make_nvp("summary", m->summary()));
+                } else {
+                    const auto& old  = last->summary();
+                    const auto& next = m->summary();
+                    a(cereal::make_nvp("summary", make_diff(old, next)));
+                }
+                a(cereal::make_nvp("cursor", m->cursor),
+                  cereal::make_nvp("paused", m->paused));
+            }
+            auto name = first ? "status" : "update";
+            first     = false;
+            last      = std::move(m);
+            return event_t{name, s.str()};
+        };
+    }
+
     static std::string join_args_(int argc, const char** argv)
     {
         assert(argc > 0);
@@ -455,18 +988,21 @@ public:
     http_debug_server(int argc,
                       const char** argv,
                       std::uint16_t port,
-                      std::string resources_path)
+                      std::string resources_path,
+                      http_debug_server_options options = {})
         : argc_{argc}
         , argv_{argv}
         , port_{port}
         , resources_path_{std::move(resources_path)}
+        , options_{options}
     {}
 
     template <typename Debugger>
     auto make(Debugger)
     {
         using handle_t = detail::http_debug_server_impl<Debugger>;
-        return std::make_shared<handle_t>(argc_, argv_, port_, resources_path_);
+        return std::make_shared<handle_t>(
+            argc_, argv_, port_, resources_path_, options_);
     }
 
 private:
@@ -474,6 +1010,7 @@ private:
     const char** argv_;
     std::uint16_t port_;
     std::string resources_path_;
+    http_debug_server_options options_;
 };
 
 } // namespace lager
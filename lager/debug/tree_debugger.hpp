@@ -14,6 +14,7 @@
 
 #include <lager/config.hpp>
 #include <lager/context.hpp>
+#include <lager/effect.hpp>
 #include <lager/util.hpp>
 
 #include <immer/algorithm.hpp>
@@ -27,11 +28,83 @@
 #include <lager/extra/cereal/variant_with_name.hpp>
 #include <lager/extra/struct.hpp>
 
+#include <cereal/types/optional.hpp>
+
+#include <algorithm>
 #include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
 #include <variant>
+#include <vector>
 
 namespace lager {
 
+/*!
+ * Configures how the `tree_debugger` stores the models of its steps.
+ */
+struct tree_debugger_limits
+{
+    //! Only every `checkpoint_interval` steps, counting from the initial
+    //! model, keep their model.  The models in between are recomputed by
+    //! replaying the actions from the closest previous checkpoint.
+    std::size_t checkpoint_interval = 1;
+    //! Maximum number of recomputed models kept for reuse.
+    std::size_t cache_size = 64;
+};
+
+namespace detail {
+
+/*!
+ * Least recently used cache of the models recomputed by the `tree_debugger`,
+ * keyed by the step that produced them.  It is shared by all versions of the
+ * debugger model, and it can be accessed from multiple threads.  Entries keep
+ * their step alive, such that its address is not reused by another step.
+ */
+template <typename Step, typename Model>
+class replay_cache
+{
+    using entry_t = std::pair<immer::box<Step>, Model>;
+
+    std::size_t capacity_;
+    std::list<entry_t> entries_;
+    std::unordered_map<const Step*, typename std::list<entry_t>::iterator>
+        index_;
+    std::mutex mutex_;
+
+public:
+    replay_cache(std::size_t capacity)
+        : capacity_{capacity}
+    {}
+
+    std::optional<Model> find(const immer::box<Step>& step)
+    {
+        auto lock = std::lock_guard<std::mutex>{mutex_};
+        auto it   = index_.find(&step.get());
+        if (it == index_.end())
+            return std::nullopt;
+        entries_.splice(entries_.begin(), entries_, it->second);
+        return it->second->second;
+    }
+
+    void insert(const immer::box<Step>& step, Model model)
+    {
+        auto lock = std::lock_guard<std::mutex>{mutex_};
+        if (capacity_ == 0 || index_.count(&step.get()))
+            return;
+        entries_.emplace_front(step, std::move(model));
+        index_.emplace(&step.get(), entries_.begin());
+        if (entries_.size() > capacity_) {
+            index_.erase(&entries_.back().first.get());
+            entries_.pop_back();
+        }
+    }
+};
+
+} // namespace detail
+
 template <typename Action, typename Model, typename Deps>
 struct tree_debugger
 {
@@ -83,11 +156,15 @@ struct tree_debugger
     struct step
     {
         Action action;
-        Model model;
+        //! Empty when the step is not a checkpoint
+        std::optional<Model> model;
         immer::vector<history> branches;
         LAGER_STRUCT_NESTED(step, action, model, branches);
     };
 
+    using replay_fn    = std::function<Model(Model, const Action&)>;
+    using replay_cache = detail::replay_cache<step, Model>;
+
     struct summary_step_t;
 
     using summary_history_t = immer::vector<immer::box<summary_step_t>>;
@@ -109,16 +186,30 @@ struct tree_debugger
         immer::vector<Action> pending   = {};
         LAGER_STRUCT_NESTED(model, cursor, paused, init, branches, pending);
 
+        tree_debugger_limits limits = {};
+        //! Step at the cursor, such that its model is found in constant time
+        std::optional<immer::box<step>> cursor_step = std::nullopt;
+        //! Summary of `branches`, updated as steps are appended
+        summary_t steps_summary = {};
+        //! Model at the cursor, when its step does not keep it
+        std::optional<Model> replayed = std::nullopt;
+        //! Recomputes a model from the previous one, without effects
+        std::shared_ptr<const replay_fn> replay = {};
+        std::shared_ptr<replay_cache> cache =
+            std::make_shared<replay_cache>(limits.cache_size);
+
         model() = default;
-        model(Model i)
+        model(Model i, tree_debugger_limits l = {})
             : init{i}
+            , limits{l}
         {}
 
-        using lookup_result = std::pair<std::optional<Action>, const Model&>;
+        using lookup_result = std::pair<std::optional<Action>, Model>;
 
-        lookup_result do_lookup(const immer::vector<history>& branches,
-                                const cursor_t& cursor,
-                                std::size_t cursor_index) const
+        const immer::box<step>&
+        do_lookup(const immer::vector<history>& branches,
+                  const cursor_t& cursor,
+                  std::size_t cursor_index) const
         {
             auto pos = cursor[cursor_index];
             if (pos.branch >= branches.size())
@@ -129,22 +220,86 @@ struct tree_debugger
             auto& node      = history[pos.step];
             auto next_index = cursor_index + 1;
             return next_index == cursor.size()
-                       ? lookup_result{node->action, node->model}
+                       ? node
                        : do_lookup(node->branches, cursor, next_index);
         }
 
         lookup_result lookup(const cursor_t& cursor) const
         {
-            return cursor.empty() ? lookup_result{{}, init}
-                                  : do_lookup(branches, cursor, 0);
+            if (cursor.empty())
+                return {{}, init};
+            auto& node = do_lookup(branches, cursor, 0);
+            return {node->action,
+                    node->model ? *node->model : model_at(cursor)};
+        }
+
+        /*!
+         * Returns the steps from the initial model to the one at `cursor`.
+         */
+        std::vector<immer::box<step>> path_to(const cursor_t& cursor) const
+        {
+            auto result   = std::vector<immer::box<step>>{};
+            auto branches = this->branches;
+            for (auto pos : cursor) {
+                auto& history = branches[pos.branch];
+                for (auto i = std::size_t{}; i <= pos.step; ++i)
+                    result.push_back(history[i]);
+                branches = history[pos.step]->branches;
+            }
+            return result;
+        }
+
+        /*!
+         * Returns the model after the step at `cursor`, replaying the actions
+         * from the closest previous checkpoint or recently recomputed model.
+         */
+        Model model_at(const cursor_t& cursor) const
+        {
+            auto path   = path_to(cursor);
+            auto pos    = path.size();
+            auto result = std::optional<Model>{};
+            for (; pos > 0 && !result; --pos) {
+                auto& node = path[pos - 1];
+                result = node->model ? node->model : cache->find(node);
+            }
+            if (result)
+                ++pos;
+            else
+                result = init;
+            for (; pos < path.size(); ++pos)
+                result = (*replay)(std::move(*result), path[pos]->action);
+            if (!path.empty() && !path.back()->model)
+                cache->insert(path.back(), *result);
+            return std::move(*result);
+        }
+
+        void seek(const cursor_t& pos)
+        {
+            cursor      = pos;
+            cursor_step = pos.empty() ? std::nullopt
+                                      : std::optional<immer::box<step>>{
+                                            do_lookup(branches, pos, 0)};
+            replayed    = !cursor_step || cursor_step->get().model
+                              ? std::nullopt
+                              : std::optional<Model>{model_at(pos)};
+        }
+
+        /*!
+         * Number of steps from the initial model to the one at `cursor`.
+         */
+        static std::size_t depth(const cursor_t& cursor)
+        {
+            auto result = std::size_t{};
+            for (auto pos : cursor)
+                result += pos.step + 1;
+            return result;
         }
 
         std::pair<immer::vector<history>, cursor_t>
         do_append(const immer::vector<history>& branches,
                   const cursor_t& cursor,
                   std::size_t cursor_index,
-                  const Action& act,
-                  const Model& m)
+                  const immer::box<step>& new_step)
         {
             using namespace std;
             auto pos          = cursor[cursor_index];
@@ -155,7 +310,7 @@ struct tree_debugger
                     return history.update(pos.step, [&](auto node_) {
                         return node_.update([&](auto node) {
                             tie(node.branches, new_cursor) = do_append(
-                                node.branches, cursor, next_index, act, m);
+                                node.branches, cursor, next_index, new_step);
                             return node;
                         });
                     });
@@ -163,13 +318,13 @@ struct tree_debugger
                     if (pos.step + 1 == history.size()) {
                         new_cursor = cursor.set(cursor_index,
                                                 {pos.branch, pos.step + 1});
-                        return history.push_back(step{act, m, {}});
+                        return history.push_back(new_step);
                     } else {
-                        new_cursor = cursor.push_back({0, 0});
                         return history.update(pos.step, [&](auto node_) {
-                            auto node = *node_;
-                            node.branches =
-                                node.branches.push_back({step{act, m, {}}});
+                            auto node     = *node_;
+                            node.branches = node.branches.push_back({new_step});
+                            new_cursor =
+                                cursor.push_back({node.branches.size() - 1, 0});
                             return node;
                         });
                     }
@@ -178,27 +333,127 @@ struct tree_debugger
             return {new_branches, new_cursor};
         }
 
-        void append(const Action& act, const Model& m)
+        /*!
+         * Finds the element of the summary of a history that covers `step`,
+         * returning its index and the position of the step within it.
+         */
+        static std::pair<std::size_t, std::size_t>
+        locate_summary(const summary_history_t& history, std::size_t step)
+        {
+            auto index = std::size_t{};
+            for (; index + 1 < history.size(); ++index) {
+                auto length = history[index]->steps + 1;
+                if (step < length)
+                    break;
+                step -= length;
+            }
+            return {index, step};
+        }
+
+        /*!
+         * Updates the summary for a step appended after the one at `cursor`,
+         * in the same way as `do_append()` updates the branches.
+         */
+        summary_t do_append_summary(const summary_t& summary,
+                                    const cursor_t& cursor,
+                                    std::size_t cursor_index,
+                                    bool at_end) const
+        {
+            auto pos        = cursor[cursor_index];
+            auto next_index = cursor_index + 1;
+            auto new_branch = summary_history_t{{summary_step_t{1, {}}}};
+            return summary.update(pos.branch, [&](auto history) {
+                auto [index, offset] = locate_summary(history, pos.step);
+                if (next_index < cursor.size()) {
+                    return history.update(index, [&](auto elem) {
+                        return elem.update([&](auto elem) {
+                            elem.branches = do_append_summary(
+                                elem.branches, cursor, next_index, at_end);
+                            return elem;
+                        });
+                    });
+                } else if (at_end) {
+                    return history.update(history.size() - 1, [](auto elem) {
+                        return elem.update([](auto elem) {
+                            ++elem.steps;
+                            return elem;
+                        });
+                    });
+                } else if (offset == history[index]->steps) {
+                    return history.update(index, [&](auto elem) {
+                        return elem.update([&](auto elem) {
+                            elem.branches = elem.branches.push_back(new_branch);
+                            return elem;
+                        });
+                    });
+                } else {
+                    auto elem   = *history[index];
+                    auto before = summary_step_t{offset, {new_branch}};
+                    auto after  = summary_step_t{elem.steps - offset - 1,
+                                                elem.branches};
+                    auto result = history.take(index).push_back(before);
+                    result      = result.push_back(after);
+                    for (auto i = index + 1; i < history.size(); ++i)
+                        result = result.push_back(history[i]);
+                    return result;
+                }
+            });
+        }
+
+        void append(const Action& act, Model m)
         {
             using namespace std;
+            auto interval   = std::max(limits.checkpoint_interval, size_t{1});
+            auto checkpoint = (depth(cursor) + 1) % interval == 0;
+            auto new_step   = immer::box<step>{step{
+                act,
+                checkpoint ? std::optional<Model>{m} : std::optional<Model>{},
+                {}}};
             if (cursor.empty()) {
-                branches = branches.push_back({step{act, m, {}}});
-                cursor   = {{branches.size() - 1, 0}};
+                branches = branches.push_back({new_step});
+                steps_summary =
+                    steps_summary.push_back({{summary_step_t{1, {}}}});
+                cursor = {{branches.size() - 1, 0}};
             } else {
-                tie(branches, cursor) = do_append(branches, cursor, 0, act, m);
+                auto at_end = is_last(cursor);
+                steps_summary =
+                    do_append_summary(steps_summary, cursor, 0, at_end);
+                tie(branches, cursor) =
+                    do_append(branches, cursor, 0, new_step);
             }
+            cursor_step = new_step;
+            replayed    = checkpoint ? std::nullopt
+                                     : std::optional<Model>{std::move(m)};
+        }
+
+        /*!
+         * Whether the step at `cursor` is the last one of its history.
+         */
+        bool is_last(const cursor_t& cursor) const
+        {
+            auto branches = &this->branches;
+            for (auto i = std::size_t{}; i + 1 < cursor.size(); ++i)
+                branches = &(*branches)[cursor[i].branch][cursor[i].step]
+                                ->branches;
+            auto pos = cursor.back();
+            return pos.step + 1 == (*branches)[pos.branch].size();
         }
 
         bool check(const cursor_t& cursor) const
         {
             LAGER_TRY {
-                lookup(cursor);
+                if (!cursor.empty())
+                    do_lookup(branches, cursor, 0);
                 return true;
             } LAGER_CATCH(const std::runtime_error&) {
                 return false;
             }
         }
 
+        /*!
+         * Computes the summary of `branches` from scratch.  The summary of
+         * the whole tree is otherwise maintained as steps are appended.
+         */
         summary_t do_summary(const immer::vector<history>& branches) const
         {
             auto result = summary_t{}.transient();
@@ -209,7 +464,8 @@ struct tree_debugger
                     if (step->branches.empty())
                         ++steps;
                     else {
-                        current.push_back({steps, do_summary(step->branches)});
+                        current.push_back(
+                            summary_step_t{steps, do_summary(step->branches)});
                         steps = 0;
                     }
                 });
@@ -219,9 +475,15 @@ struct tree_debugger
             return std::move(result).persistent();
         }
 
-        summary_t summary() const { return do_summary(branches); }
+        const summary_t& summary() const { return steps_summary; }
 
-        operator const Model&() const { return lookup(cursor).second; }
+        operator const Model&() const
+        {
+            if (cursor.empty())
+                return init;
+            return cursor_step->get().model ? *cursor_step->get().model
+                                            : *replayed;
+        }
 
         friend decltype(auto) unwrap(const model& m)
         {
@@ -241,30 +503,40 @@ struct tree_debugger
                         m.pending = m.pending.push_back(act);
                         return m;
                     } else {
+                        if (!m.replay)
+                            m.replay = std::make_shared<const replay_fn>(
+                                [reducer](Model model, const Action& act) {
+                                    return invoke_reducer<deps_t>(
+                                        reducer,
+                                        std::move(model),
+                                        act,
+                                        [](auto&&) {},
+                                        [] {});
+                                });
                         auto eff   = effect<action, deps_t>{noop};
                         auto state = invoke_reducer<deps_t>(
                             reducer,
-                            m,
+                            static_cast<const Model&>(m),
                             act,
                             [&](auto&& e) { eff = LAGER_FWD(e); },
                             [] {});
-                        m.append(act, state);
+                        m.append(act, std::move(state));
                         return {m, eff};
                     }
                 },
                 [&](goto_action act) -> result_t {
                     if (m.check(act.cursor))
-                        m.cursor = act.cursor;
+                        m.seek(act.cursor);
                     return m;
                 },
                 [&](undo_action) -> result_t {
                     if (!m.cursor.empty()) {
                         auto index = m.cursor.size() - 1;
                         auto pos   = m.cursor.back();
-                        m.cursor   = pos.step > 0
-                                       ? m.cursor.set(
-                                             index, {pos.branch, pos.step - 1})
-                                       : m.cursor.take(index);
+                        m.seek(pos.step > 0 ? m.cursor.set(
+                                                  index,
+                                                  {pos.branch, pos.step - 1})
+                                            : m.cursor.take(index));
                     }
                     return m;
                 },
@@ -17,7 +17,9 @@
 #include <boost/hana/at_key.hpp>
 #include <boost/hana/filter.hpp>
 #include <boost/hana/find.hpp>
+#include <boost/hana/for_each.hpp>
 #include <boost/hana/intersection.hpp>
+#include <boost/hana/keys.hpp>
 #include <boost/hana/map.hpp>
 #include <boost/hana/set.hpp>
 #include <boost/hana/tuple.hpp>
@@ -25,6 +27,8 @@
 #include <boost/hana/unpack.hpp>
 
 #include <functional>
+#include <memory>
+#include <mutex>
 #include <optional>
 #include <stdexcept>
 #include <type_traits>
@@ -50,6 +54,14 @@ template <typename T>
 constexpr auto is_reference_wrapper_v =
     is_reference_wrapper<std::decay_t<T>>::value;
 
+template <typename T, typename Enable = void>
+struct has_value_member : std::false_type
+{};
+template <typename T>
+struct has_value_member<T, std::void_t<decltype(std::declval<T&>().value)>>
+    : std::true_type
+{};
+
 } // namespace detail
 
 /*!
@@ -70,6 +82,10 @@ struct spec
     {
         return true;
     }
+
+    template <typename Storage>
+    static void prewarm(Storage&& x)
+    {}
 };
 
 template <typename T>
@@ -175,6 +191,13 @@ struct opt : to_spec<T>
         return bool{x};
     }
 
+    template <typename Storage>
+    static void prewarm(Storage&& x)
+    {
+        if (x)
+            to_spec<T>::prewarm(*std::forward<Storage>(x));
+    }
+
     static storage extract(storage st) { return std::move(st); }
 };
 
@@ -194,9 +217,99 @@ struct fn : to_spec<T>
         return to_spec<T>::get(std::forward<Storage>(fn)());
     }
 
+    template <typename Storage>
+    static void prewarm(Storage&& x)
+    {}
+
     static storage extract(storage st) { return std::move(st); }
 };
 
+/*!
+ * Modifies specification or type `T` to make it lazily constructed by a
+ * function, the first time it is requested.  The result is cached and shared
+ * by all the copies of the `deps` containing it, so the function is called at
+ * most once even when the dependency is requested concurrently.  If the
+ * function throws, it is called again on the next request.
+ *
+ * Lazy dependencies of value type are returned by reference, such that they
+ * can be used for expensive services.  Use `lager::prewarm()` to build them
+ * ahead of time, for example, from a worker thread.
+ *
+ * A lazy dependency can be converted to a non-lazy one.  This forces its
+ * construction.
+ */
+template <typename T>
+struct lazy : to_spec<T>
+{
+    using type         = lazy;
+    using base_storage = typename to_spec<T>::storage;
+
+    class storage
+    {
+    public:
+        storage() = default;
+
+        template <typename Fn,
+                  std::enable_if_t<!std::is_same_v<std::decay_t<Fn>, storage> &&
+                                       std::is_invocable_r_v<base_storage, Fn&>,
+                                   int> = 0>
+        storage(Fn fn)
+            : state_{std::make_shared<state_t>(std::move(fn))}
+        {}
+
+        base_storage& force() const
+        {
+            if (!state_)
+                LAGER_THROW(missing_dependency_error{
+                    "missing lazy dependency in lager::deps"});
+            std::call_once(state_->flag, [&] {
+                state_->value.emplace(state_->make());
+                state_->make = nullptr;
+            });
+            return *state_->value;
+        }
+
+        decltype(auto) operator()() const { return deref(force()); }
+
+    private:
+        struct state_t
+        {
+            std::once_flag flag;
+            std::function<base_storage()> make;
+            std::optional<base_storage> value;
+
+            state_t(std::function<base_storage()> fn)
+                : make{std::move(fn)}
+            {}
+        };
+
+        std::shared_ptr<state_t> state_;
+    };
+
+    template <typename Storage>
+    static decltype(auto) get(Storage&& x)
+    {
+        return deref(x.force());
+    }
+
+    template <typename Storage>
+    static void prewarm(Storage&& x)
+    {
+        x.force();
+    }
+
+    static storage extract(storage st) { return std::move(st); }
+
+private:
+    static decltype(auto) deref(base_storage& x)
+    {
+        if constexpr (lager::detail::has_value_member<base_storage>::value)
+            return (x.value);
+        else
+            return to_spec<T>::get(x);
+    }
+};
+
 /*!
  * Modifies specification or type `T` to associate it with type tag `K`.
  */
@@ -400,6 +513,17 @@ public:
         return spec_t::has(storage_[get_key_t<Key>{}]);
     }
 
+    /*!
+     * Forces the construction of all lazy dependencies.
+     */
+    void prewarm() const
+    {
+        boost::hana::for_each(boost::hana::keys(spec_map), [&](auto key) {
+            using spec_t = std::decay_t<decltype(spec_map[key])>;
+            spec_t::prewarm(storage_[key]);
+        });
+    }
+
     /*!
      * Returns a new dependencies object that contains all dependencies in this
      * object and `other`.  If the two objects provide a dependency with the
@@ -497,6 +621,27 @@ bool has(const deps<Ts...>& d)
     return d.template has<Key>();
 }
 
+/*!
+ * Free standing alias for `deps::prewarm()`.  Lazy dependencies are shared
+ * between copies of a `deps`, so this can be used with a copy of the
+ * dependencies of a store, from a worker thread, to build them without
+ * blocking the event loop:
+ *
+ * @rst
+ *
+ * .. code-block:: c++
+ *
+ *    auto services = lager::deps<lager::dep::lazy<database>>{store};
+ *    std::thread{[services] { lager::prewarm(services); }}.detach();
+ *
+ * @endrst
+ */
+template <typename... Ts>
+void prewarm(const deps<Ts...>& d)
+{
+    d.prewarm();
+}
+
 /*!
  * Metafunction to see if something is a deps type.
  */
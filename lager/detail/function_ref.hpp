@@ -0,0 +1,57 @@
+//
+// lager - library for functional interactive c++ programs
+// Copyright (C) 2017 Juan Pedro Bolivar Puente
+//
+// This file is part of lager.
+//
+// lager is free software: you can redistribute it and/or modify
+// it under the terms of the MIT License, as detailed in the LICENSE
+// file located at the root of this source code distribution,
+// or here: <https://github.com/arximboldi/lager/blob/master/LICENSE>
+//
+
+
+#pragma once
+
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+namespace lager {
+namespace detail {
+
+template <typename Sig>
+class function_ref;
+
+/*!
+ * Non owning reference to a callable.  It is cheaper than a `std::function`
+ * because it never allocates, but the referenced callable must outlive it.
+ * Used to pass callbacks through virtual interfaces of nodes.
+ */
+template <typename R, typename... Args>
+class function_ref<R(Args...)>
+{
+    void* obj_;
+    R (*call_)(void*, Args...);
+
+public:
+    template <typename Fn,
+              std::enable_if_t<
+                  !std::is_same_v<std::decay_t<Fn>, function_ref>,
+                  int> = 0>
+    function_ref(Fn&& fn)
+        : obj_{const_cast<void*>(static_cast<const void*>(std::addressof(fn)))}
+        , call_{[](void* obj, Args... args) -> R {
+            return (*static_cast<std::remove_reference_t<Fn>*>(obj))(
+                std::forward<Args>(args)...);
+        }}
+    {}
+
+    R operator()(Args... args) const
+    {
+        return call_(obj_, std::forward<Args>(args)...);
+    }
+};
+
+} // namespace detail
+} // namespace lager
@@ -0,0 +1,41 @@
+//
+// lager - library for functional interactive c++ programs
+// Copyright (C) 2017 Juan Pedro Bolivar Puente
+//
+// This file is part of lager.
+//
+// lager is free software: you can redistribute it and/or modify
+// it under the terms of the MIT License, as detailed in the LICENSE
+// file located at the root of this source code distribution,
+// or here: <https://github.com/arximboldi/lager/blob/master/LICENSE>
+//
+
+#pragma once
+
+#include <immer/map.hpp>
+
+#include <cstdint>
+#include <type_traits>
+
+namespace lager {
+namespace detail {
+
+template <typename T>
+struct is_immer_map : std::false_type
+{};
+
+template <typename K,
+          typename T,
+          typename Hash,
+          typename Equal,
+          typename MemoryPolicy,
+          std::uint32_t B>
+struct is_immer_map<immer::map<K, T, Hash, Equal, MemoryPolicy, B>>
+    : std::true_type
+{};
+
+template <typename T>
+constexpr bool is_immer_map_v = is_immer_map<T>::value;
+
+} // namespace detail
+} // namespace lager
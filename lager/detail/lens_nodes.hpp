@@ -28,6 +28,25 @@ namespace lager {
 
 namespace detail {
 
+/*!
+ * Lenses whose view is an optional of a part stored in the whole, like
+ * `lenses::alternative`, can provide `view_ptr(whole)`.  It returns a pointer
+ * to the part, or null when the whole does not hold it.  Setting a value
+ * through such lens must assign the part when it is held, and leave the whole
+ * unchanged otherwise.  Lens nodes with a single parent use it to compare and
+ * assign the part in place, instead of copying it in and out of an optional.
+ */
+template <typename Lens, typename WholesPack, typename Enable = void>
+struct has_view_ptr : std::false_type
+{};
+
+template <typename Lens, typename Whole>
+struct has_view_ptr<Lens,
+                    zug::meta::pack<Whole>,
+                    std::void_t<decltype(std::declval<const Lens&>().view_ptr(
+                        std::declval<Whole&>()))>> : std::true_type
+{};
+
 template <typename Lens               = zug::identity_t,
           typename ParentsPack        = zug::meta::pack<>,
           template <class> class Base = reader_node>
@@ -50,9 +69,15 @@ class lens_reader_node<Lens, zug::meta::pack<Parents...>, Base>
         Base>;
 
 protected:
+    static constexpr bool view_by_ptr =
+        has_view_ptr<Lens,
+                     zug::meta::pack<zug::meta::value_t<Parents>...>>::value;
+
     Lens lens_;
 
 public:
+    using value_type = typename base_t::value_type;
+
     template <typename Lens2, typename ParentsTuple>
     lens_reader_node(Lens2&& l, ParentsTuple&& parents)
         : base_t{view(l, current_from(parents)),
@@ -62,7 +87,16 @@ public:
 
     void recompute() final
     {
-        this->push_down(view(lens_, current_from(this->parents())));
+        if constexpr (view_by_ptr) {
+            auto part = lens_.view_ptr(std::get<0>(this->parents())->current());
+            auto& last = this->current();
+            if (!part)
+                this->push_down(value_type{});
+            else if (!last || has_changed(*part, *last))
+                this->push_down(value_type{*part});
+        } else {
+            this->push_down(view(lens_, current_from(this->parents())));
+        }
     }
 };
 
@@ -86,15 +120,67 @@ public:
 
     void send_up(const value_type& value) final
     {
-        this->refresh();
-        this->push_up(set(this->lens_, current_from(this->parents()), value));
+        if (this->batch_send_up(value))
+            return;
+        set_parents(value);
     }
 
     void send_up(value_type&& value) final
     {
-        this->refresh();
-        this->push_up(
-            set(this->lens_, current_from(this->parents()), std::move(value)));
+        if (this->batch_send_up(std::move(value)))
+            return;
+        set_parents(std::move(value));
+    }
+
+    void send_up_with(function_ref<value_type(value_type&&)> fn) final
+    {
+        if (this->in_batch())
+            return cursor_node<value_type>::send_up_with(fn);
+        update_parents(
+            [&](auto&& part) { return fn(value_type(LAGER_FWD(part))); });
+    }
+
+private:
+    template <typename T>
+    void set_parents(T&& value)
+    {
+        if constexpr (base_t::view_by_ptr) {
+            std::get<0>(this->parents())->send_up_with([&](auto&& whole) {
+                if (value.has_value())
+                    if (auto part = this->lens_.view_ptr(whole))
+                        *part = std::forward<T>(value).value();
+                return std::move(whole);
+            });
+        } else {
+            update_parents([&](auto&&) { return std::forward<T>(value); });
+        }
+    }
+
+    /*!
+     * Sets the part of the parents focused by the lens to the result of
+     * `fn`.  With a single parent, the update is done on a value owned by the
+     * write, so the lens can move the untouched parts of the whole instead of
+     * copying them.
+     */
+    template <typename Fn>
+    void update_parents(Fn&& fn)
+    {
+        if constexpr (base_t::view_by_ptr) {
+            std::get<0>(this->parents())->send_up_with([&](auto&& whole) {
+                auto part  = this->lens_.view_ptr(whole);
+                auto value = fn(part ? value_type{*part} : value_type{});
+                if (part && value.has_value())
+                    *part = std::move(value).value();
+                return std::move(whole);
+            });
+        } else if constexpr (sizeof...(Parents) == 1) {
+            std::get<0>(this->parents())->send_up_with([&](auto&& whole) {
+                return over(this->lens_, LAGER_FWD(whole), fn);
+            });
+        } else {
+            this->refresh();
+            this->push_up(over(this->lens_, current_from(this->parents()), fn));
+        }
     }
 };
 
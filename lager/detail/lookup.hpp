@@ -0,0 +1,92 @@
+//
+// lager - library for functional interactive c++ programs
+// Copyright (C) 2017 Juan Pedro Bolivar Puente
+//
+// This file is part of lager.
+//
+// lager is free software: you can redistribute it and/or modify
+// it under the terms of the MIT License, as detailed in the LICENSE
+// file located at the root of this source code distribution,
+// or here: <https://github.com/arximboldi/lager/blob/master/LICENSE>
+//
+
+#pragma once
+
+#include <lager/config.hpp>
+
+#include <zug/meta/detected.hpp>
+
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+namespace lager {
+namespace detail {
+
+template <typename T>
+using mapped_type_t = typename T::mapped_type;
+
+template <typename T, typename Key>
+using find_t = decltype(std::declval<T&>().find(std::declval<const Key&>()));
+
+template <typename T>
+using size_t_t = decltype(std::declval<const T&>().size());
+
+template <typename T, typename Key>
+using subscript_t = decltype(std::declval<T&>()[std::declval<const Key&>()]);
+
+// associative containers with `find()`, like `std::map` or `immer::map`
+template <typename T, typename Key>
+constexpr bool is_findable_v =
+    zug::meta::is_detected<mapped_type_t, T>::value &&
+    zug::meta::is_detected<find_t, T, Key>::value;
+
+// sequences indexed by position, like `std::vector` or `immer::flex_vector`
+template <typename T, typename Key>
+constexpr bool is_indexable_v =
+    !zug::meta::is_detected<mapped_type_t, T>::value &&
+    std::is_integral_v<Key> && zug::meta::is_detected<size_t_t, T>::value &&
+    zug::meta::is_detected<subscript_t, T, Key>::value;
+
+/*!
+ * Returns a pointer to the element at `key` in `whole`, or `nullptr` if there
+ * is no such element.  When the container provides `find()`, or is indexable
+ * by position, this does a single lookup and throws no exceptions.
+ * Otherwise, it falls back to `at()`, catching `std::out_of_range`.
+ */
+template <typename Whole, typename Key>
+auto lookup(Whole& whole, const Key& key)
+{
+    using result_t = decltype(std::addressof(whole.at(key)));
+    if constexpr (is_findable_v<Whole, Key>) {
+        auto it = whole.find(key);
+        if constexpr (std::is_pointer_v<decltype(it)>)
+            return result_t{it};
+        else
+            return it == whole.end() ? result_t{} : std::addressof(it->second);
+    } else if constexpr (is_indexable_v<Whole, Key>) {
+        return static_cast<std::size_t>(key) < whole.size()
+                   ? std::addressof(whole[key])
+                   : result_t{};
+    } else {
+        LAGER_TRY {
+            return std::addressof(whole.at(key));
+        } LAGER_CATCH(std::out_of_range const&) {
+            return result_t{};
+        }
+    }
+}
+
+/*!
+ * Returns whether there is an element at `key` in `whole`.
+ */
+template <typename Whole, typename Key>
+bool contains(const Whole& whole, const Key& key)
+{
+    return lookup(whole, key) != nullptr;
+}
+
+} // namespace detail
+} // namespace lager
@@ -64,8 +64,17 @@ public:
     using value_type = typename base_t::value_type;
     using base_t::base_t;
 
-    void send_up(const value_type& value) final { this->push_up(value); }
-    void send_up(value_type&& value) final { this->push_up(std::move(value)); }
+    void send_up(const value_type& value) final
+    {
+        if (!this->batch_send_up(value))
+            this->push_up(value);
+    }
+
+    void send_up(value_type&& value) final
+    {
+        if (!this->batch_send_up(std::move(value)))
+            this->push_up(std::move(value));
+    }
 };
 
 /*!
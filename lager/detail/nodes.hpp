@@ -38,6 +38,7 @@
 
 #pragma once
 
+#include <lager/detail/function_ref.hpp>
 #include <lager/detail/signal.hpp>
 #include <lager/util.hpp>
 
@@ -45,8 +46,12 @@
 #include <zug/tuplify.hpp>
 
 #include <algorithm>
+#include <atomic>
+#include <cstdint>
 #include <functional>
 #include <memory>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
 namespace lager {
@@ -112,6 +117,18 @@ auto has_changed(const T&, const T&)
     return true;
 }
 
+/*!
+ * Global counter that is incremented every time the value of a node changes.
+ * Nodes are stamped with it to find out cheaply whether they are up to date.
+ *
+ * It is shared by all the nodes in the process, so a change anywhere makes
+ * every node look possibly stale until it is refreshed again, and stores in
+ * different threads increment the same counter.  It only needs to be unique,
+ * since a node graph is never used from several threads at once, so it is
+ * accessed with relaxed ordering.
+ */
+inline std::atomic<std::uint64_t> node_epoch{0};
+
 struct notifying_guard_t
 {
     notifying_guard_t(bool& target)
@@ -149,6 +166,11 @@ public:
     const value_type& current() const { return current_; }
     const value_type& last() const { return last_; }
 
+    /*!
+     * Value of `node_epoch` when the current value of this node last changed.
+     */
+    std::uint64_t changed_epoch() const { return changed_epoch_; }
+
     void link(std::weak_ptr<reader_node_base> child)
     {
         using namespace std;
@@ -166,6 +188,8 @@ public:
         if (has_changed(value, current_)) {
             current_         = std::forward<U>(value);
             needs_send_down_ = true;
+            changed_epoch_ =
+                node_epoch.fetch_add(1, std::memory_order_relaxed) + 1;
         }
     }
 
@@ -224,6 +248,7 @@ private:
     value_type last_;
     std::vector<std::weak_ptr<reader_node_base>> children_;
     signal_type observers_;
+    std::uint64_t changed_epoch_ = 0;
 
     bool needs_send_down_ = false;
     bool needs_notify_    = false;
@@ -238,7 +263,71 @@ class cursor_node
     : public reader_node<T>
     , public writer_node_base<T>
 {
+public:
     using reader_node<T>::reader_node;
+
+    /*!
+     * Starts a batch of writes.  Until the matching `end_batch()`, the values
+     * sent up to this node are kept in the node instead of being propagated to
+     * its parents, and the node is not recomputed from them.  Batches can be
+     * nested.
+     */
+    void begin_batch()
+    {
+        if (batch_depth_++ == 0)
+            this->refresh();
+    }
+
+    /*!
+     * Ends a batch of writes.  When the outermost batch ends, the accumulated
+     * value, if any, is sent up in one go.
+     */
+    void end_batch()
+    {
+        if (--batch_depth_ == 0 && std::exchange(batch_dirty_, false)) {
+            auto value = this->current();
+            this->send_up(std::move(value));
+        }
+    }
+
+    bool in_batch() const { return batch_depth_ > 0; }
+
+    /*!
+     * Sends up the result of applying `fn` to the current value of the node,
+     * which `fn` receives as an rvalue.  By default the current value is
+     * copied, but nodes that derive their value from their parent can
+     * override this to forward the update to the parent instead.  This way,
+     * writing through a chain of lenses copies the root value once and moves
+     * it through the rest of the chain, instead of copying the whole at every
+     * level.  For this to be safe, lenses must only move from the whole in
+     * their setter, never while viewing it.
+     */
+    virtual void send_up_with(function_ref<T(T&&)> fn)
+    {
+        this->refresh();
+        auto value = this->current();
+        this->send_up(fn(std::move(value)));
+    }
+
+protected:
+    /*!
+     * To be called by `send_up()` implementations before doing anything else.
+     * Returns whether the value was captured by the current batch, in which
+     * case there is nothing left to do.
+     */
+    template <typename U>
+    bool batch_send_up(U&& value)
+    {
+        if (batch_depth_ == 0)
+            return false;
+        this->push_down(std::forward<U>(value));
+        batch_dirty_ = true;
+        return true;
+    }
+
+private:
+    std::size_t batch_depth_ = 0;
+    bool batch_dirty_        = false;
 };
 
 template <typename T,
@@ -253,6 +342,7 @@ class inner_node<ValueT, zug::meta::pack<Parents...>, Base>
     using base_t = Base<ValueT>;
 
     std::tuple<std::shared_ptr<Parents>...> parents_;
+    std::uint64_t refreshed_epoch_ = 0;
 
 public:
     inner_node(ValueT init, std::tuple<std::shared_ptr<Parents>...>&& parents)
@@ -260,11 +350,31 @@ public:
         , parents_{std::move(parents)}
     {}
 
+    /*!
+     * Makes sure that the node is up to date with its parents.  The node is
+     * only recomputed when one of its parents changed since its last refresh.
+     * When no node at all changed since then it returns right away, but
+     * otherwise, even if the change happened in an unrelated node, it still
+     * refreshes all its ancestors to find out.
+     */
     void refresh() final
     {
-        std::apply([&](auto&&... ps) { noop((ps->refresh(), 0)...); },
-                   parents_);
-        this->recompute();
+        if constexpr (std::is_base_of_v<cursor_node<ValueT>, base_t>)
+            if (this->in_batch())
+                return;
+        auto epoch = node_epoch.load(std::memory_order_relaxed);
+        if (refreshed_epoch_ == epoch)
+            return;
+        auto stale = std::apply(
+            [&](auto&&... ps) {
+                noop((ps->refresh(), 0)...);
+                return (false || ... ||
+                        (ps->changed_epoch() > refreshed_epoch_));
+            },
+            parents_);
+        if (stale)
+            this->recompute();
+        refreshed_epoch_ = node_epoch.load(std::memory_order_relaxed);
     }
 
     const std::tuple<std::shared_ptr<Parents>...>& parents() const
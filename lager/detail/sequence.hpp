@@ -0,0 +1,205 @@
+//
+// lager - library for functional interactive c++ programs
+// Copyright (C) 2017 Juan Pedro Bolivar Puente
+//
+// This file is part of lager.
+//
+// lager is free software: you can redistribute it and/or modify
+// it under the terms of the MIT License, as detailed in the LICENSE
+// file located at the root of this source code distribution,
+// or here: <https://github.com/arximboldi/lager/blob/master/LICENSE>
+//
+
+#pragma once
+
+#include <lager/detail/nodes.hpp>
+
+#include <immer/algorithm.hpp>
+#include <zug/meta/detected.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+namespace lager {
+namespace detail {
+
+template <typename T, typename U>
+bool same_element(const T& a, const U& b)
+{
+    return std::addressof(a) == std::addressof(b) || !has_changed(a, b);
+}
+
+// whether the sequence is an `immer` one, which can be walked by chunks
+template <typename Seq, typename = void>
+struct is_immer_sequence : std::false_type
+{};
+
+template <typename Seq>
+struct is_immer_sequence<Seq, std::void_t<typename Seq::memory_policy>>
+    : std::true_type
+{};
+
+/*!
+ * Returns the length of the longest common prefix and suffix of the sequences
+ * `a` and `b`, that do not overlap.  Elements shared structurally among the
+ * sequences are recognized without comparing their values.  For `immer`
+ * sequences, whole leaves shared by both sequences are skipped at once, so
+ * finding the unchanged ends after updating, adding or removing a few
+ * elements takes time proportional to the number of leaves, not elements.
+ */
+template <typename Seq>
+std::pair<std::size_t, std::size_t> common_ends(const Seq& a, const Seq& b)
+{
+    auto max = std::min(a.size(), b.size());
+    if constexpr (is_immer_sequence<Seq>::value) {
+        // whether the chunk `[first, last)` of `a`, starting at position `i`,
+        // is at the same place in `b`, when `b` is offset by `offset`
+        auto shared = [&](auto first, auto last, std::size_t i, auto offset) {
+            return std::addressof(b[i + offset]) == first &&
+                   std::addressof(b[i + offset + (last - first) - 1]) ==
+                       last - 1;
+        };
+        auto prefix = std::size_t{};
+        if (max > 0)
+            immer::for_each_chunk_p(
+                a.begin(), a.begin() + max, [&](auto first, auto last) {
+                    if (shared(first, last, prefix, 0)) {
+                        prefix += last - first;
+                        return true;
+                    }
+                    for (; first != last && same_element(*first, b[prefix]);
+                         ++first)
+                        ++prefix;
+                    return first == last;
+                });
+        // the suffix is the run of common elements that reaches the end
+        auto suffix = std::size_t{};
+        auto offset = b.size() - a.size();
+        auto i      = a.size() - (max - prefix);
+        if (i < a.size() && same_element(a.back(), b.back()))
+            immer::for_each_chunk_p(
+                a.begin() + i, a.end(), [&](auto first, auto last) {
+                    auto size = static_cast<std::size_t>(last - first);
+                    if (shared(first, last, i, offset)) {
+                        suffix += size;
+                    } else {
+                        auto n = std::size_t{};
+                        while (n < size &&
+                               same_element(first[size - n - 1],
+                                            b[i + offset + size - n - 1]))
+                            ++n;
+                        suffix = n == size ? suffix + n : n;
+                    }
+                    i += size;
+                    return true;
+                });
+        return {prefix, suffix};
+    } else {
+        auto prefix = std::size_t{};
+        for (auto ia = a.begin(), ib = b.begin();
+             prefix < max && same_element(*ia, *ib);
+             ++ia, ++ib)
+            ++prefix;
+        auto suffix = std::size_t{};
+        for (auto ia = std::make_reverse_iterator(a.end()),
+                  ib = std::make_reverse_iterator(b.end());
+             prefix + suffix < max && same_element(*ia, *ib);
+             ++ia, ++ib)
+            ++suffix;
+        return {prefix, suffix};
+    }
+}
+
+template <typename Seq, typename T>
+using persistent_set_t =
+    decltype(std::declval<const Seq&>().set(std::size_t{}, std::declval<T>()));
+
+template <typename Seq, typename T>
+using persistent_push_back_t =
+    decltype(std::declval<const Seq&>().push_back(std::declval<T>()));
+
+template <typename Seq>
+using persistent_erase_t =
+    decltype(std::declval<const Seq&>().erase(std::size_t{}));
+
+// whether `push_back()` returns a new sequence instead of modifying it
+template <typename Seq, typename T, typename = void>
+struct is_persistent_push_back : std::false_type
+{};
+
+template <typename Seq, typename T>
+struct is_persistent_push_back<Seq,
+                               T,
+                               std::void_t<persistent_push_back_t<Seq, T>>>
+    : std::is_same<persistent_push_back_t<Seq, T>, Seq>
+{};
+
+// whether `erase()` takes a position and returns a new sequence
+template <typename Seq, typename = void>
+struct is_persistent_erase : std::false_type
+{};
+
+template <typename Seq>
+struct is_persistent_erase<Seq, std::void_t<persistent_erase_t<Seq>>>
+    : std::is_same<persistent_erase_t<Seq>, Seq>
+{};
+
+/*!
+ * Returns `seq` with the element at position `i` replaced by `value`.  Works
+ * with persistent sequences, like the ones in `immer`, as well as mutable
+ * ones, like `std::vector`.
+ */
+template <typename Seq, typename T>
+Seq replace_at(Seq seq, std::size_t i, T&& value)
+{
+    if constexpr (zug::meta::is_detected<persistent_set_t, Seq, T>::value) {
+        return std::move(seq).set(i, std::forward<T>(value));
+    } else {
+        seq[i] = std::forward<T>(value);
+        return seq;
+    }
+}
+
+/*!
+ * Returns `seq` with `value` added at the end.
+ */
+template <typename Seq, typename T>
+Seq push_back(Seq seq, T&& value)
+{
+    if constexpr (is_persistent_push_back<Seq, T>::value) {
+        return std::move(seq).push_back(std::forward<T>(value));
+    } else {
+        seq.push_back(std::forward<T>(value));
+        return seq;
+    }
+}
+
+/*!
+ * Returns `seq` without the element at position `i`.
+ */
+template <typename Seq>
+Seq erase_at(Seq seq, std::size_t i)
+{
+    if constexpr (is_persistent_erase<Seq>::value) {
+        return std::move(seq).erase(i);
+    } else if constexpr (zug::meta::is_detected<persistent_set_t,
+                                                Seq,
+                                                typename Seq::value_type>::
+                             value) {
+        // persistent sequences that can not erase, like `immer::vector`
+        auto result = seq.take(i);
+        for (auto j = i + 1, size = seq.size(); j < size; ++j)
+            result = std::move(result).push_back(seq[j]);
+        return result;
+    } else {
+        seq.erase(std::next(seq.begin(), i));
+        return seq;
+    }
+}
+
+} // namespace detail
+} // namespace lager
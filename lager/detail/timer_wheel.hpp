@@ -0,0 +1,295 @@
+//
+// lager - library for functional interactive c++ programs
+// Copyright (C) 2017 Juan Pedro Bolivar Puente
+//
+// This file is part of lager.
+//
+// lager is free software: you can redistribute it and/or modify
+// it under the terms of the MIT License, as detailed in the LICENSE
+// file located at the root of this source code distribution,
+// or here: <https://github.com/arximboldi/lager/blob/master/LICENSE>
+//
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <utility>
+#include <vector>
+
+namespace lager {
+namespace detail {
+
+/*!
+ * Hierarchical timer wheel, used to implement timers in event loops that do
+ * not have a native timer facility.
+ *
+ * Time is divided in ticks of a fixed resolution.  Timers are kept in one of
+ * `levels` wheels of `slots` buckets each, such that a timer expiring in less
+ * than `slots^(n+1)` ticks lives in the `n`-th wheel.  Adding and cancelling a
+ * timer are constant time operations.  Advancing the wheel costs a constant
+ * amount of work per expired timer and per elapsed tick, but stretches of
+ * time with no timers about to expire are skipped at once.
+ *
+ * The wheel itself is not thread-safe.
+ */
+class timer_wheel
+{
+public:
+    using clock      = std::chrono::steady_clock;
+    using time_point = clock::time_point;
+    using duration   = clock::duration;
+    using event_fn   = std::function<void()>;
+    using id_t       = std::uint64_t;
+
+    timer_wheel(time_point origin   = clock::now(),
+                duration resolution = std::chrono::milliseconds{1})
+        : origin_{origin}
+        , resolution_{resolution}
+    {
+        heads_.fill(nil);
+    }
+
+    /*!
+     * Schedules `fn` to be fired at `when`.  When `period` is non zero, the
+     * timer is fired again every `period` until it is cancelled.  Returns an
+     * identifier that can be used to cancel the timer.
+     *
+     * Periodic timers are due at `when` plus a whole number of periods, and
+     * only the tick in which they are fired is rounded, so they do not drift
+     * when the period is not a multiple of the resolution.
+     */
+    id_t add(time_point when, event_fn fn, duration period = {})
+    {
+        auto index = std::uint32_t{};
+        if (free_.empty()) {
+            index = static_cast<std::uint32_t>(timers_.size());
+            timers_.emplace_back();
+        } else {
+            index = free_.back();
+            free_.pop_back();
+        }
+        auto& t    = timers_[index];
+        t.fn       = std::move(fn);
+        t.deadline = when - origin_;
+        // timers are always fired in a future tick, at the earliest
+        t.expiry = std::max(ticks_until_(t.deadline), tick_ + 1);
+        t.period = std::max(period, duration{});
+        t.active = true;
+        link_(index);
+        ++size_;
+        return (id_t{t.generation} << 32) | index;
+    }
+
+    /*!
+     * Cancels the timer with identifier `id`.  Returns whether the timer was
+     * still scheduled.
+     */
+    bool cancel(id_t id)
+    {
+        auto index = static_cast<std::uint32_t>(id);
+        if (index >= timers_.size())
+            return false;
+        auto& t = timers_[index];
+        if (!t.active || t.generation != static_cast<std::uint32_t>(id >> 32))
+            return false;
+        unlink_(index);
+        release_(index);
+        return true;
+    }
+
+    /*!
+     * Number of scheduled timers.
+     */
+    std::size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+
+    /*!
+     * Fires all the timers that expire at or before `now`, passing the
+     * callback of each of them to `fire`, in order of expiry.  A timer that
+     * was missed multiple times, because the wheel was not advanced often
+     * enough, is only fired once.
+     */
+    template <typename Fn>
+    void advance(time_point now, Fn&& fire)
+    {
+        auto target = to_ticks_(now);
+        while (tick_ < target) {
+            if (size_ == 0) {
+                tick_ = target;
+                break;
+            }
+            skip_idle_ticks_(target);
+            if (tick_ == target)
+                break;
+            ++tick_;
+            for (auto level = levels - 1; level > 0; --level)
+                if ((tick_ & low_mask_(level)) == 0)
+                    cascade_(level, slot_(tick_, level));
+            expire_(target, fire);
+        }
+    }
+
+private:
+    using tick_t = std::uint64_t;
+
+    static constexpr std::size_t slot_bits = 8;
+    static constexpr std::size_t slots     = std::size_t{1} << slot_bits;
+    static constexpr std::size_t levels    = 4;
+
+    static constexpr auto nil = std::numeric_limits<std::uint32_t>::max();
+
+    struct entry_t
+    {
+        event_fn fn;
+        tick_t expiry            = 0;
+        duration deadline        = {};
+        duration period          = {};
+        std::uint32_t generation = 1;
+        std::uint32_t bucket     = 0;
+        std::uint32_t prev       = nil;
+        std::uint32_t next       = nil;
+        bool active              = false;
+    };
+
+    static constexpr tick_t low_mask_(std::size_t level)
+    {
+        return (tick_t{1} << (slot_bits * level)) - 1;
+    }
+
+    static constexpr std::size_t slot_(tick_t tick, std::size_t level)
+    {
+        return static_cast<std::size_t>((tick >> (slot_bits * level)) &
+                                        (slots - 1));
+    }
+
+    // last tick that started at or before `p`
+    tick_t to_ticks_(time_point p) const
+    {
+        auto d = p - origin_;
+        return d > duration{} ? static_cast<tick_t>(d / resolution_) : 0;
+    }
+
+    // first tick that starts at or after `d`, such that timers are never fired
+    // before they are due
+    tick_t ticks_until_(duration d) const
+    {
+        return d > duration{} ? static_cast<tick_t>(
+                                    (d + resolution_ - duration{1}) /
+                                    resolution_)
+                              : 0;
+    }
+
+    void link_(std::uint32_t index)
+    {
+        auto& t    = timers_[index];
+        auto delta = t.expiry - tick_;
+        auto level = std::size_t{};
+        while (level < levels - 1 && delta > low_mask_(level + 1))
+            ++level;
+        // timers too far in the future wait in the last slot that can hold
+        // them and are re-scheduled when it is cascaded
+        auto slot_tick = std::min(t.expiry, tick_ + low_mask_(levels));
+        auto bucket = static_cast<std::uint32_t>(level * slots +
+                                                 slot_(slot_tick, level));
+        t.bucket = bucket;
+        t.prev   = nil;
+        t.next   = heads_[bucket];
+        if (t.next != nil)
+            timers_[t.next].prev = index;
+        heads_[bucket] = index;
+        ++counts_[level];
+    }
+
+    void unlink_(std::uint32_t index)
+    {
+        auto& t = timers_[index];
+        if (t.prev != nil)
+            timers_[t.prev].next = t.next;
+        else
+            heads_[t.bucket] = t.next;
+        if (t.next != nil)
+            timers_[t.next].prev = t.prev;
+        t.prev = t.next = nil;
+        --counts_[t.bucket / slots];
+    }
+
+    void release_(std::uint32_t index)
+    {
+        auto& t  = timers_[index];
+        t.fn     = nullptr;
+        t.active = false;
+        ++t.generation;
+        free_.push_back(index);
+        --size_;
+    }
+
+    std::uint32_t take_bucket_(std::size_t bucket)
+    {
+        auto head = std::exchange(heads_[bucket], nil);
+        for (auto i = head; i != nil; i = timers_[i].next)
+            --counts_[bucket / slots];
+        return head;
+    }
+
+    void cascade_(std::size_t level, std::size_t slot)
+    {
+        for (auto i = take_bucket_(level * slots + slot); i != nil;) {
+            auto next = timers_[i].next;
+            link_(i);
+            i = next;
+        }
+    }
+
+    template <typename Fn>
+    void expire_(tick_t target, Fn& fire)
+    {
+        for (auto i = take_bucket_(slot_(tick_, 0)); i != nil;) {
+            auto& t    = timers_[i];
+            auto next  = t.next;
+            t.prev = t.next = nil;
+            if (t.period > duration{}) {
+                // the next deadline after `target`, skipping missed periods
+                auto last = static_cast<duration::rep>(target) * resolution_;
+                t.deadline += ((last - t.deadline) / t.period + 1) * t.period;
+                t.expiry = ticks_until_(t.deadline);
+                link_(i);
+                fire(event_fn{t.fn});
+            } else {
+                auto fn = std::move(t.fn);
+                release_(i);
+                fire(std::move(fn));
+            }
+            i = next;
+        }
+    }
+
+    // When the lower wheels are empty nothing can expire before the next
+    // cascade of the first non empty wheel, so we can jump right before it.
+    void skip_idle_ticks_(tick_t target)
+    {
+        auto level = std::size_t{};
+        while (level < levels && counts_[level] == 0)
+            ++level;
+        if (level > 0 && level < levels) {
+            auto next_cascade = (tick_ | low_mask_(level)) + 1;
+            tick_             = std::min(target, next_cascade - 1);
+        }
+    }
+
+    time_point origin_;
+    duration resolution_;
+    tick_t tick_       = 0;
+    std::size_t size_  = 0;
+    std::vector<entry_t> timers_;
+    std::vector<std::uint32_t> free_;
+    std::array<std::uint32_t, levels * slots> heads_;
+    std::array<std::size_t, levels> counts_ = {};
+};
+
+} // namespace detail
+} // namespace lager
@@ -137,8 +137,17 @@ public:
         , up_step_{wxform(send_up_rf)}
     {}
 
-    void send_up(const value_type& value) final { up_step_(this, value); }
-    void send_up(value_type&& value) final { up_step_(this, std::move(value)); }
+    void send_up(const value_type& value) final
+    {
+        if (!this->batch_send_up(value))
+            up_step_(this, value);
+    }
+
+    void send_up(value_type&& value) final
+    {
+        if (!this->batch_send_up(std::move(value)))
+            up_step_(this, std::move(value));
+    }
 };
 
 /*!
@@ -14,6 +14,8 @@
 
 #include <lager/context.hpp>
 
+#include <exception>
+
 namespace lager {
 
 //! @defgroup effects
@@ -262,6 +264,72 @@ auto sequence(effect<A1, D1> a, effect<A2, D2> b, Effs&&... effects)
                     std::forward<Effs>(effects)...);
 }
 
+/*!
+ * Returns an effect that evaluates the effect @a eff in a worker thread, using
+ * the `async()` method of the event loop associated to the context.  Use it to
+ * mark effects that are independent of any other effect, like blocking I/O or
+ * CPU intensive work, so they do not hold the event loop while running.
+ *
+ * The context passed to @a eff can be used from the worker thread, actions
+ * dispatched through it are delivered in the event loop.  The resulting future
+ * is completed in the event loop once @a eff, and the future it returns,
+ * complete.  Exceptions thrown by @a eff are rethrown in the event loop.
+ *
+ * @note The event loop must support `async()` and its `post()` method must be
+ *       thread-safe.
+ */
+template <typename Action, typename Deps>
+effect<Action, Deps> concurrent(effect<Action, Deps> eff)
+{
+    using context_t = typename effect<Action, Deps>::context_t;
+    if (is_empty_effect(eff))
+        return eff;
+    return [eff = std::move(eff)](const context_t& ctx) -> future {
+        auto [p, f] = promise::with_post(
+            [ctx](auto&& fn) { ctx.loop().post(LAGER_FWD(fn)); });
+        ctx.loop().async([eff, ctx, p = std::move(p)]() mutable {
+            LAGER_TRY {
+                auto r = eff(ctx);
+                ctx.loop().post(
+                    [p = std::move(p), r = std::move(r)]() mutable {
+                        std::move(r).then(std::move(p));
+                    });
+            } LAGER_CATCH(...) {
+                ctx.loop().post([err = std::current_exception()] {
+                    std::rethrow_exception(err);
+                });
+            }
+        });
+        return std::move(f);
+    };
+}
+
+/*!
+ * Returns an effect that evaluates the effects @a a and @a b without waiting
+ * for each other.  The resulting future completes when both complete.  This
+ * is most useful in combination with `concurrent()`.
+ */
+template <typename Actions1, typename Deps1, typename Actions2, typename Deps2>
+auto parallel(effect<Actions1, Deps1> a, effect<Actions2, Deps2> b)
+{
+    using deps_t = decltype(std::declval<Deps1>().merge(std::declval<Deps2>()));
+    using actions_t = detail::merge_actions_t<Actions1, Actions2>;
+    using result_t  = effect<actions_t, deps_t>;
+
+    return is_empty_effect(a) && is_empty_effect(b) ? result_t{noop}
+           : is_empty_effect(a)                     ? result_t{b}
+           : is_empty_effect(b)
+               ? result_t{a}
+               : result_t{[a, b](auto&& ctx) { return a(ctx).also(b(ctx)); }};
+}
+
+template <typename A1, typename D1, typename A2, typename D2, typename... Effs>
+auto parallel(effect<A1, D1> a, effect<A2, D2> b, Effs&&... effects)
+{
+    return parallel(parallel(std::move(a), std::move(b)),
+                    std::forward<Effs>(effects)...);
+}
+
 //! @} group: effects
 
 } // namespace lager
@@ -12,13 +12,20 @@
 
 #pragma once
 
+#include <lager/timer.hpp>
+
+#include <boost/asio/bind_executor.hpp>
 #include <boost/asio/executor_work_guard.hpp>
 #include <boost/asio/io_context.hpp>
 #include <boost/asio/post.hpp>
+#include <boost/asio/steady_timer.hpp>
 #include <boost/asio/strand.hpp>
 
+#include <chrono>
 #include <functional>
+#include <memory>
 #include <thread>
+#include <type_traits>
 #include <utility>
 
 namespace lager {
@@ -64,10 +71,76 @@ struct with_boost_asio_event_loop
         boost::asio::post(executor, std::forward<Fn>(fn));
     }
 
+    /*!
+     * Schedules `fn` after `delay` using a `boost::asio::steady_timer`.
+     */
+    template <typename Fn>
+    timer_handle post_after(std::chrono::steady_clock::duration delay, Fn&& fn)
+    {
+        return start_timer_(delay, {}, std::forward<Fn>(fn));
+    }
+
+    template <typename Fn>
+    timer_handle post_every(std::chrono::steady_clock::duration period,
+                            Fn&& fn)
+    {
+        return start_timer_(period, period, std::forward<Fn>(fn));
+    }
+
     void pause() {}
     void resume() {}
 
     void finish() { stop(); }
+
+private:
+    using steady_timer_t = boost::asio::steady_timer;
+
+    timer_handle start_timer_(std::chrono::steady_clock::duration delay,
+                              std::chrono::steady_clock::duration period,
+                              std::function<void()> fn)
+    {
+        auto timer = make_timer_(delay);
+        arm_timer_(executor, timer, period, std::move(fn));
+        return timer_handle{
+            [ex = executor, weak = std::weak_ptr<steady_timer_t>{timer}] {
+                boost::asio::post(ex, [weak] {
+                    if (auto timer = weak.lock())
+                        timer->cancel();
+                });
+            }};
+    }
+
+    std::shared_ptr<steady_timer_t>
+    make_timer_(std::chrono::steady_clock::duration delay)
+    {
+        // legacy `io_context::strand` is not an executor usable by timers
+        if constexpr (std::is_constructible_v<steady_timer_t,
+                                              Executor,
+                                              decltype(delay)>)
+            return std::make_shared<steady_timer_t>(executor, delay);
+        else
+            return std::make_shared<steady_timer_t>(executor.context(), delay);
+    }
+
+    static void arm_timer_(Executor ex,
+                           std::shared_ptr<steady_timer_t> timer,
+                           std::chrono::steady_clock::duration period,
+                           std::function<void()> fn)
+    {
+        auto& t = *timer;
+        t.async_wait(boost::asio::bind_executor(
+            ex,
+            [ex, timer = std::move(timer), period, fn = std::move(fn)](
+                boost::system::error_code ec) mutable {
+                if (ec)
+                    return;
+                if (period == std::chrono::steady_clock::duration{})
+                    return fn();
+                timer->expires_at(timer->expiry() + period);
+                fn();
+                arm_timer_(ex, std::move(timer), period, std::move(fn));
+            }));
+    }
 };
 
 } // namespace lager
@@ -80,6 +80,24 @@ public:
         }
     }
 
+    /*!
+     * Timers are fired from `step()`, thus their resolution is bound to the
+     * refresh rate of the item.  Must be called from the thread of the item.
+     */
+    template <typename Fn>
+    timer_handle post_after(queue_event_loop::duration delay, Fn&& fn)
+    {
+        polish();
+        return queue_.post_after(delay, std::forward<Fn>(fn));
+    }
+
+    template <typename Fn>
+    timer_handle post_every(queue_event_loop::duration period, Fn&& fn)
+    {
+        polish();
+        return queue_.post_every(period, std::forward<Fn>(fn));
+    }
+
     void finish() { LAGER_THROW(std::logic_error{"not implemented!"}); }
     void pause() { LAGER_THROW(std::logic_error{"not implemented!"}); }
     void resume() { LAGER_THROW(std::logic_error{"not implemented!"}); }
@@ -104,6 +122,16 @@ struct with_qml_event_loop
     {
         loop.get().post(std::forward<Fn>(fn));
     }
+    template <typename Fn>
+    timer_handle post_after(queue_event_loop::duration delay, Fn&& fn)
+    {
+        return loop.get().post_after(delay, std::forward<Fn>(fn));
+    }
+    template <typename Fn>
+    timer_handle post_every(queue_event_loop::duration period, Fn&& fn)
+    {
+        return loop.get().post_every(period, std::forward<Fn>(fn));
+    }
     void finish() { loop.get().finish(); }
     void pause() { loop.get().pause(); }
     void resume() { loop.get().resume(); }
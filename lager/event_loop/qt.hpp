@@ -13,11 +13,15 @@
 #pragma once
 
 #include <lager/config.hpp>
+#include <lager/timer.hpp>
 
 #include <QObject>
+#include <QPointer>
 #include <QThreadPool>
+#include <QTimer>
 #include <QtConcurrent>
 
+#include <chrono>
 #include <functional>
 #include <stdexcept>
 #include <utility>
@@ -45,10 +49,49 @@ struct with_qt_event_loop
             &obj.get(), std::forward<Fn>(fn), Qt::QueuedConnection);
     }
 
+    /*!
+     * Schedules `fn` after `delay` using a `QTimer` owned by `obj`.  Must be
+     * called from the thread of `obj`.
+     */
+    template <typename Fn>
+    timer_handle post_after(std::chrono::steady_clock::duration delay, Fn&& fn)
+    {
+        return start_timer_(delay, true, std::forward<Fn>(fn));
+    }
+
+    template <typename Fn>
+    timer_handle post_every(std::chrono::steady_clock::duration period,
+                            Fn&& fn)
+    {
+        return start_timer_(period, false, std::forward<Fn>(fn));
+    }
+
     void finish() { QCoreApplication::instance()->quit(); }
 
     void pause() { LAGER_THROW(std::runtime_error{"not implemented!"}); }
     void resume() { LAGER_THROW(std::runtime_error{"not implemented!"}); }
+
+private:
+    timer_handle start_timer_(std::chrono::steady_clock::duration delay,
+                              bool single_shot,
+                              std::function<void()> fn)
+    {
+        auto timer = new QTimer{&obj.get()};
+        timer->setSingleShot(single_shot);
+        QObject::connect(
+            timer, &QTimer::timeout, timer, [timer, fn = std::move(fn)] {
+                if (timer->isSingleShot())
+                    timer->deleteLater();
+                fn();
+            });
+        timer->start(std::chrono::ceil<std::chrono::milliseconds>(delay));
+        return timer_handle{[timer = QPointer<QTimer>{timer}] {
+            if (timer) {
+                timer->stop();
+                timer->deleteLater();
+            }
+        }};
+    }
 };
 
 } // namespace lager
@@ -13,7 +13,10 @@
 #pragma once
 
 #include <lager/config.hpp>
+#include <lager/detail/timer_wheel.hpp>
+#include <lager/timer.hpp>
 
+#include <chrono>
 #include <functional>
 #include <stdexcept>
 #include <utility>
@@ -23,9 +26,37 @@ namespace lager {
 
 struct queue_event_loop
 {
-    using event_fn = std::function<void()>;
+    using event_fn   = std::function<void()>;
+    using clock      = std::chrono::steady_clock;
+    using duration   = clock::duration;
+    using time_point = clock::time_point;
 
     void post(event_fn ev) { queue_.push_back(std::move(ev)); }
+
+    /*!
+     * Schedules `ev` to be run by the first call to `step()` that happens at
+     * or after `when`.
+     */
+    timer_handle post_at(time_point when, event_fn ev)
+    {
+        return make_handle_(timers_.add(when, std::move(ev)));
+    }
+
+    timer_handle post_after(duration delay, event_fn ev)
+    {
+        return post_at(clock::now() + delay, std::move(ev));
+    }
+
+    /*!
+     * Schedules `ev` to be run every `period`.  When `step()` is not called
+     * often enough, missed periods are skipped.
+     */
+    timer_handle post_every(duration period, event_fn ev)
+    {
+        return make_handle_(
+            timers_.add(clock::now() + period, std::move(ev), period));
+    }
+
     void finish() { LAGER_THROW(std::logic_error{"not implemented!"}); }
     void pause() { LAGER_THROW(std::logic_error{"not implemented!"}); }
     void resume() { LAGER_THROW(std::logic_error{"not implemented!"}); }
@@ -39,6 +70,10 @@ struct queue_event_loop
     // queue to be fully processed.
     void step()
     {
+        if (!timers_.empty())
+            timers_.advance(clock::now(), [&](event_fn ev) {
+                queue_.push_back(std::move(ev));
+            });
         for (auto i = std::size_t{}; i < queue_.size();) {
             try {
                 auto f = std::move(queue_[i++]);
@@ -52,7 +87,13 @@ struct queue_event_loop
     }
 
 private:
+    timer_handle make_handle_(detail::timer_wheel::id_t id)
+    {
+        return timer_handle{[this, id] { timers_.cancel(id); }};
+    }
+
     std::vector<event_fn> queue_;
+    detail::timer_wheel timers_;
 };
 
 struct with_queue_event_loop
@@ -69,6 +110,16 @@ struct with_queue_event_loop
     {
         loop.get().post(std::forward<Fn>(fn));
     }
+    template <typename Fn>
+    timer_handle post_after(queue_event_loop::duration delay, Fn&& fn)
+    {
+        return loop.get().post_after(delay, std::forward<Fn>(fn));
+    }
+    template <typename Fn>
+    timer_handle post_every(queue_event_loop::duration period, Fn&& fn)
+    {
+        return loop.get().post_every(period, std::forward<Fn>(fn));
+    }
     void finish() { loop.get().finish(); }
     void pause() { loop.get().pause(); }
     void resume() { loop.get().resume(); }
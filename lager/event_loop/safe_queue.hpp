@@ -13,7 +13,10 @@
 #pragma once
 
 #include <lager/config.hpp>
+#include <lager/detail/timer_wheel.hpp>
+#include <lager/timer.hpp>
 
+#include <chrono>
 #include <functional>
 #include <mutex>
 #include <stdexcept>
@@ -25,7 +28,10 @@ namespace lager {
 
 struct safe_queue_event_loop
 {
-    using event_fn = std::function<void()>;
+    using event_fn   = std::function<void()>;
+    using clock      = std::chrono::steady_clock;
+    using duration   = clock::duration;
+    using time_point = clock::time_point;
 
     void post(event_fn ev)
     {
@@ -38,6 +44,32 @@ struct safe_queue_event_loop
         }
     }
 
+    /*!
+     * Schedules `ev` to be run by the first call to `step()` that happens at
+     * or after `when`.  Like `post()`, this can be called from any thread.
+     */
+    timer_handle post_at(time_point when, event_fn ev)
+    {
+        std::lock_guard<std::mutex> guard{mutex_};
+        return make_handle_(timers_.add(when, std::move(ev)));
+    }
+
+    timer_handle post_after(duration delay, event_fn ev)
+    {
+        return post_at(clock::now() + delay, std::move(ev));
+    }
+
+    /*!
+     * Schedules `ev` to be run every `period`.  When `step()` is not called
+     * often enough, missed periods are skipped.
+     */
+    timer_handle post_every(duration period, event_fn ev)
+    {
+        std::lock_guard<std::mutex> guard{mutex_};
+        return make_handle_(
+            timers_.add(clock::now() + period, std::move(ev), period));
+    }
+
     void finish() { LAGER_THROW(std::logic_error{"not implemented!"}); }
     void pause() { LAGER_THROW(std::logic_error{"not implemented!"}); }
     void resume() { LAGER_THROW(std::logic_error{"not implemented!"}); }
@@ -54,6 +86,7 @@ struct safe_queue_event_loop
         assert(thread_id_ == std::this_thread::get_id());
         run_local_queue_();
         swap_queues_();
+        expire_timers_();
         run_local_queue_();
     }
 
@@ -72,6 +105,23 @@ private:
         swap(local_queue_, shared_queue_);
     }
 
+    void expire_timers_()
+    {
+        std::lock_guard<std::mutex> guard{mutex_};
+        if (!timers_.empty())
+            timers_.advance(clock::now(), [&](event_fn ev) {
+                local_queue_.push_back(std::move(ev));
+            });
+    }
+
+    timer_handle make_handle_(detail::timer_wheel::id_t id)
+    {
+        return timer_handle{[this, id] {
+            std::lock_guard<std::mutex> guard{mutex_};
+            timers_.cancel(id);
+        }};
+    }
+
     void run_local_queue_()
     {
         for (auto i = std::size_t{}; i < local_queue_.size();) {
@@ -91,6 +141,7 @@ private:
     std::mutex mutex_;
     std::vector<event_fn> shared_queue_;
     std::vector<event_fn> local_queue_;
+    detail::timer_wheel timers_;
 };
 
 struct with_safe_queue_event_loop
@@ -107,6 +158,16 @@ struct with_safe_queue_event_loop
     {
         loop.get().post(std::forward<Fn>(fn));
     }
+    template <typename Fn>
+    timer_handle post_after(safe_queue_event_loop::duration delay, Fn&& fn)
+    {
+        return loop.get().post_after(delay, std::forward<Fn>(fn));
+    }
+    template <typename Fn>
+    timer_handle post_every(safe_queue_event_loop::duration period, Fn&& fn)
+    {
+        return loop.get().post_every(period, std::forward<Fn>(fn));
+    }
     void finish() { loop.get().finish(); }
     void pause() { loop.get().pause(); }
     void resume() { loop.get().resume(); }
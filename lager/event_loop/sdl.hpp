@@ -13,11 +13,13 @@
 #pragma once
 
 #include <lager/config.hpp>
+#include <lager/timer.hpp>
 
 #include <SDL2/SDL.h>
 
 #include <algorithm>
 #include <atomic>
+#include <chrono>
 #include <functional>
 #include <memory>
 #include <stdexcept>
@@ -179,6 +181,21 @@ struct sdl_event_loop
 #endif
     }
 
+    /*!
+     * Schedules `ev` to be posted after `delay`, using `SDL_AddTimer()`.
+     */
+    timer_handle post_after(std::chrono::steady_clock::duration delay,
+                            event_fn ev)
+    {
+        return start_timer_(delay, false, std::move(ev));
+    }
+
+    timer_handle post_every(std::chrono::steady_clock::duration period,
+                            event_fn ev)
+    {
+        return start_timer_(period, true, std::move(ev));
+    }
+
     void finish() { done_ = true; }
     void pause() { paused_ = true; }
     void resume() { paused_ = false; }
@@ -186,6 +203,84 @@ struct sdl_event_loop
 private:
     friend with_sdl_event_loop;
 
+    struct timer_state
+    {
+        event_fn fn;
+        sdl_event_loop* loop;
+        std::uint32_t period;
+        std::atomic<bool> active{true};
+#if __EMSCRIPTEN__
+        long id = 0;
+        std::shared_ptr<timer_state> self;
+#endif
+    };
+
+    timer_handle start_timer_(std::chrono::steady_clock::duration delay,
+                              bool periodic,
+                              event_fn ev)
+    {
+        auto ms = static_cast<std::uint32_t>(std::max<long long>(
+            0, std::chrono::ceil<std::chrono::milliseconds>(delay).count()));
+        auto state = std::make_shared<timer_state>();
+        state->fn     = std::move(ev);
+        state->loop   = this;
+        state->period = periodic ? std::max<std::uint32_t>(ms, 1) : 0;
+#if !__EMSCRIPTEN__
+        // The callback runs in a separate SDL thread and owns a reference to
+        // the state, which is released once the timer stops.
+        SDL_AddTimer(
+            std::max<std::uint32_t>(ms, 1),
+            [](std::uint32_t, void* data) -> std::uint32_t {
+                auto holder = static_cast<std::shared_ptr<timer_state>*>(data);
+                auto& state = **holder;
+                if (state.active) {
+                    state.loop->post([s = *holder] {
+                        if (s->active) {
+                            if (!s->period)
+                                s->active = false;
+                            s->fn();
+                        }
+                    });
+                    if (state.period)
+                        return state.period;
+                }
+                delete holder;
+                return 0;
+            },
+            new std::shared_ptr<timer_state>{state});
+#else
+        // Emscripten is single-threaded, we can fire the callbacks directly.
+        // The state keeps itself alive until the timer stops.
+        auto fire = [](void* data) {
+            auto state = static_cast<timer_state*>(data)->self;
+            if (!state->period) {
+                state->active = false;
+                state->self.reset();
+            }
+            state->fn();
+        };
+        state->self = state;
+        state->id   = periodic ? ::emscripten_set_interval(
+                                   fire, state->period, state.get())
+                               : ::emscripten_set_timeout(fire, ms, state.get());
+#endif
+        return timer_handle{[weak = std::weak_ptr<timer_state>{state}] {
+            auto state = weak.lock();
+            if (!state)
+                return;
+#if __EMSCRIPTEN__
+            if (state->active) {
+                if (state->period)
+                    ::emscripten_clear_interval(state->id);
+                else
+                    ::emscripten_clear_timeout(state->id);
+                state->self.reset();
+            }
+#endif
+            state->active = false;
+        }};
+    }
+
     std::atomic<bool> done_{false};
     std::atomic<bool> paused_{false};
     std::uint32_t post_event_type_ = SDL_RegisterEvents(1);
@@ -207,6 +302,19 @@ struct with_sdl_event_loop
         loop.get().post(std::forward<Fn>(fn));
     }
 
+    template <typename Fn>
+    timer_handle post_after(std::chrono::steady_clock::duration delay, Fn&& fn)
+    {
+        return loop.get().post_after(delay, std::forward<Fn>(fn));
+    }
+
+    template <typename Fn>
+    timer_handle post_every(std::chrono::steady_clock::duration period,
+                            Fn&& fn)
+    {
+        return loop.get().post_every(period, std::forward<Fn>(fn));
+    }
+
     void finish() { loop.get().finish(); }
     void pause() { loop.get().pause(); }
     void resume() { loop.get().resume(); }
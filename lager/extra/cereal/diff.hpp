@@ -0,0 +1,321 @@
+//
+// lager - library for functional interactive c++ programs
+// Copyright (C) 2017 Juan Pedro Bolivar Puente
+//
+// This file is part of lager.
+//
+// lager is free software: you can redistribute it and/or modify
+// it under the terms of the MIT License, as detailed in the LICENSE
+// file located at the root of this source code distribution,
+// or here: <https://github.com/arximboldi/lager/blob/master/LICENSE>
+//
+
+#pragma once
+
+#include <lager/detail/immer_traits.hpp>
+#include <lager/extra/cereal/struct.hpp>
+
+#include <cereal/cereal.hpp>
+#include <cereal/types/string.hpp>
+
+#include <boost/hana/all_of.hpp>
+#include <boost/hana/at_key.hpp>
+#include <boost/hana/concept/struct.hpp>
+#include <boost/hana/for_each.hpp>
+#include <boost/hana/keys.hpp>
+
+#include <immer/box.hpp>
+#include <immer/vector.hpp>
+
+#include <zug/meta/detected.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+namespace lager {
+
+namespace detail {
+
+template <typename T>
+struct is_immer_box : std::false_type
+{};
+
+template <typename T, typename MP>
+struct is_immer_box<immer::box<T, MP>> : std::true_type
+{};
+
+// whether the elements of the sequence are written without their box, like
+// `lager/extra/cereal/immer_vector.hpp` does for `immer::vector<immer::box>`
+template <typename T>
+struct is_unboxed_sequence : std::false_type
+{};
+
+template <typename T, typename MP, std::uint32_t B, std::uint32_t BL>
+struct is_unboxed_sequence<immer::vector<immer::box<T, MP>, MP, B, BL>>
+    : std::true_type
+{};
+
+template <typename T>
+struct is_optional : std::false_type
+{};
+
+template <typename T>
+struct is_optional<std::optional<T>> : std::true_type
+{};
+
+template <typename T>
+struct is_variant : std::false_type
+{};
+
+template <typename... Ts>
+struct is_variant<std::variant<Ts...>> : std::true_type
+{};
+
+template <typename T>
+using sequence_index_t = decltype(std::declval<const T&>()[std::size_t{}],
+                                  std::declval<const T&>().size(),
+                                  std::declval<const T&>().begin());
+
+template <typename T>
+constexpr bool is_diff_sequence_v =
+    zug::meta::is_detected<sequence_index_t, T>::value &&
+    !std::is_convertible_v<const T&, std::string>;
+
+template <typename T>
+using equality_t =
+    decltype(std::declval<const T&>() == std::declval<const T&>());
+
+/*!
+ * Whether `a` and `b` are the same value, either because they are the same
+ * object or because they compare equal.  `LAGER_STRUCT` types are compared
+ * field by field.
+ */
+template <typename T>
+bool diff_equal(const T& a, const T& b)
+{
+    if (std::addressof(a) == std::addressof(b))
+        return true;
+    if constexpr (zug::meta::is_detected<equality_t, T>::value) {
+        return a == b;
+    } else if constexpr (boost::hana::Struct<T>::value) {
+        return boost::hana::all_of(boost::hana::keys(a), [&](auto&& k) {
+            return diff_equal(boost::hana::at_key(a, k),
+                              boost::hana::at_key(b, k));
+        });
+    } else {
+        return false;
+    }
+}
+
+/*!
+ * Like `common_ends()`, but comparing the elements with `diff_equal()`.
+ */
+template <typename Seq>
+std::pair<std::size_t, std::size_t> diff_common_ends(const Seq& a,
+                                                     const Seq& b)
+{
+    auto max    = std::min(a.size(), b.size());
+    auto prefix = std::size_t{};
+    while (prefix < max && diff_equal(a[prefix], b[prefix]))
+        ++prefix;
+    auto suffix = std::size_t{};
+    while (prefix + suffix < max &&
+           diff_equal(a[a.size() - suffix - 1], b[b.size() - suffix - 1]))
+        ++suffix;
+    return {prefix, suffix};
+}
+
+/*!
+ * Appends `segment` to the JSON pointer `path`, escaping it as specified in
+ * RFC 6901.
+ */
+inline std::string diff_path(std::string path, const std::string& segment)
+{
+    path += '/';
+    for (auto c : segment) {
+        if (c == '~')
+            path += "~0";
+        else if (c == '/')
+            path += "~1";
+        else
+            path += c;
+    }
+    return path;
+}
+
+template <typename Archive>
+struct diff_op
+{
+    const char* op;
+    std::string path;
+    std::function<void(Archive&)> value;
+
+    void CEREAL_SAVE_FUNCTION_NAME(Archive& ar) const
+    {
+        ar(cereal::make_nvp("op", std::string{op}),
+           cereal::make_nvp("path", path));
+        if (value)
+            value(ar);
+    }
+};
+
+/*!
+ * Collects the operations that turn a value into another one.  Values that
+ * are shared structurally, or compare equal, are skipped without looking
+ * into them.
+ */
+template <typename Archive>
+struct diff_builder
+{
+    std::vector<diff_op<Archive>> ops;
+
+    template <typename T>
+    void replace(const std::string& path, const T& value)
+    {
+        ops.push_back({"replace", path, [&value](Archive& ar) {
+                           ar(cereal::make_nvp("value", value));
+                       }});
+    }
+
+    template <typename T>
+    void add(const std::string& path, const T& value)
+    {
+        ops.push_back({"add", path, [&value](Archive& ar) {
+                           ar(cereal::make_nvp("value", value));
+                       }});
+    }
+
+    void remove(const std::string& path)
+    {
+        ops.push_back({"remove", path, {}});
+    }
+
+    template <typename T>
+    void diff(const std::string& path, const T& old, const T& next)
+    {
+        if (std::addressof(old) == std::addressof(next))
+            return;
+        if constexpr (boost::hana::Struct<T>::value) {
+            boost::hana::for_each(boost::hana::keys(old), [&](auto&& k) {
+                auto name =
+                    cereal::serialize_camel_case<T>::value
+                        ? lager::detail::to_camel_case(k.c_str())
+                        : std::string{k.c_str()};
+                diff(diff_path(path, name),
+                     boost::hana::at_key(old, k),
+                     boost::hana::at_key(next, k));
+            });
+        } else if constexpr (is_immer_box<T>::value) {
+            // written as {"value": ...}, unless it is an element of a
+            // sequence that writes it unboxed, see `diff_sequence()`
+            diff(path + "/value", old.get(), next.get());
+        } else if constexpr (is_optional<T>::value) {
+            // written as {"nullopt": ..., "data": ...}
+            if (old && next)
+                diff(path + "/data", *old, *next);
+            else if (old || next)
+                replace(path, next);
+        } else if constexpr (is_variant<T>::value) {
+            // written as {"type": ..., "data": ...}
+            if (old.index() != next.index())
+                return replace(path, next);
+            std::visit(
+                [&](auto& a, auto& b) {
+                    using a_t = std::decay_t<decltype(a)>;
+                    using b_t = std::decay_t<decltype(b)>;
+                    if constexpr (std::is_same_v<a_t, b_t>)
+                        diff(path + "/data", a, b);
+                },
+                old,
+                next);
+        } else if constexpr (is_immer_map_v<T>) {
+            // written as an array in the order of the hash of the keys,
+            // which changes with every insertion and removal, so there is no
+            // stable path for its elements
+            if (!diff_equal(old, next))
+                replace(path, next);
+        } else if constexpr (is_diff_sequence_v<T>) {
+            diff_sequence(path, old, next);
+        } else if (!diff_equal(old, next)) {
+            replace(path, next);
+        }
+    }
+
+    template <typename Seq>
+    void diff_sequence(const std::string& path, const Seq& old, const Seq& next)
+    {
+        auto [prefix, suffix] = diff_common_ends(old, next);
+        auto old_end          = old.size() - suffix;
+        auto next_end         = next.size() - suffix;
+        auto i                = prefix;
+        auto element          = [](auto& x) -> decltype(auto) {
+            if constexpr (is_unboxed_sequence<Seq>::value)
+                return x.get();
+            else
+                return (x);
+        };
+        for (; i < old_end && i < next_end; ++i)
+            diff(diff_path(path, std::to_string(i)),
+                 element(old[i]),
+                 element(next[i]));
+        for (auto j = i; j < next_end; ++j)
+            add(diff_path(path, std::to_string(j)), element(next[j]));
+        for (auto j = i; j < old_end; ++j)
+            remove(diff_path(path, std::to_string(i)));
+    }
+};
+
+} // namespace detail
+
+/*!
+ * Serializes the changes from `old` to `next` as a JSON Patch, as specified
+ * in RFC 6902: a sequence of operations with the JSON pointer of the part of
+ * the value that changed and, for the operations that need it, its new value.
+ * The pointers address the JSON that `cereal` writes for `old`, using the
+ * serializers in `lager/extra/cereal`, so applying the patch to it results in
+ * the JSON for `next`.
+ *
+ * The diff recurses into `LAGER_STRUCT` fields, `immer::box`,
+ * `std::optional`, `std::variant`, and sequences like `immer::vector` or
+ * `immer::flex_vector`, whose changes are looked for between their common
+ * ends.  The elements of `immer::vector<immer::box<T>>` are addressed without
+ * the box, as they are written.  Elements shared structurally are skipped
+ * without comparing them.  Other values, including `immer::map`, are replaced
+ * as a whole when they compare different.
+ *
+ * Both values must outlive the serialization.
+ */
+template <typename T>
+struct value_diff
+{
+    const T& old;
+    const T& next;
+
+    template <typename Archive>
+    void CEREAL_SAVE_FUNCTION_NAME(Archive& ar) const
+    {
+        auto builder = detail::diff_builder<Archive>{};
+        builder.diff("", old, next);
+        ar(cereal::make_size_tag(
+            static_cast<cereal::size_type>(builder.ops.size())));
+        for (auto& op : builder.ops)
+            ar(op);
+    }
+};
+
+template <typename T>
+value_diff<T> make_diff(const T& old, const T& next)
+{
+    return {old, next};
+}
+
+} // namespace lager
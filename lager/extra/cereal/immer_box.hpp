@@ -12,6 +12,8 @@
 
 #pragma once
 
+#include <lager/extra/cereal/structural_sharing.hpp>
+
 #include <cereal/cereal.hpp>
 #include <immer/box.hpp>
 #include <type_traits>
@@ -21,12 +23,16 @@ namespace cereal {
 template <typename Archive, typename T, typename MP>
 void CEREAL_SAVE_FUNCTION_NAME(Archive& ar, const immer::box<T, MP>& b)
 {
+    if (lager::detail::save_shared_box(ar, b))
+        return;
     ar(cereal::make_nvp("value", b.get()));
 }
 
 template <typename Archive, typename T, typename MP>
 void CEREAL_LOAD_FUNCTION_NAME(Archive& ar, immer::box<T, MP>& b)
 {
+    if (lager::detail::load_shared_box(ar, b))
+        return;
     T x;
     ar(cereal::make_nvp("value", x));
     b = x;
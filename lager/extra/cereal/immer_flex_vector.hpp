@@ -12,6 +12,8 @@
 
 #pragma once
 
+#include <lager/extra/cereal/structural_sharing.hpp>
+
 #include <cereal/cereal.hpp>
 #include <immer/flex_vector.hpp>
 #include <immer/flex_vector_transient.hpp>
@@ -31,6 +33,8 @@ template <typename Archive,
 void CEREAL_SAVE_FUNCTION_NAME(
     Archive& ar, const immer::flex_vector<T, MP, B, BL>& flex_vector)
 {
+    if (lager::detail::save_shared_vector(ar, flex_vector))
+        return;
     ar(make_size_tag(static_cast<size_type>(flex_vector.size())));
     for (auto&& v : flex_vector)
         ar(v);
@@ -44,6 +48,8 @@ template <typename Archive,
 void CEREAL_LOAD_FUNCTION_NAME(Archive& ar,
                                immer::flex_vector<T, MP, B, BL>& flex_vector)
 {
+    if (lager::detail::load_shared_vector(ar, flex_vector))
+        return;
     size_type size{};
     ar(make_size_tag(size));
 
@@ -12,6 +12,8 @@
 
 #pragma once
 
+#include <lager/extra/cereal/structural_sharing.hpp>
+
 #include <cereal/cereal.hpp>
 #include <immer/box.hpp>
 #include <immer/vector.hpp>
@@ -32,6 +34,8 @@ template <typename Archive,
 void CEREAL_SAVE_FUNCTION_NAME(Archive& ar,
                                const immer::vector<T, MP, B, BL>& vector)
 {
+    if (lager::detail::save_shared_vector(ar, vector))
+        return;
     ar(make_size_tag(static_cast<size_type>(vector.size())));
     for (auto&& v : vector)
         ar(v);
@@ -44,6 +48,8 @@ template <typename Archive,
           std::uint32_t BL>
 void CEREAL_LOAD_FUNCTION_NAME(Archive& ar, immer::vector<T, MP, B, BL>& vector)
 {
+    if (lager::detail::load_shared_vector(ar, vector))
+        return;
     size_type size{};
     ar(make_size_tag(size));
 
@@ -69,6 +75,8 @@ template <typename Archive,
 void CEREAL_SAVE_FUNCTION_NAME(
     Archive& ar, const immer::vector<immer::box<T, MP>, MP, B, BL>& vector)
 {
+    if (lager::detail::save_shared_vector(ar, vector))
+        return;
     ar(make_size_tag(static_cast<size_type>(vector.size())));
     for (auto&& v : vector)
         ar(*v);
@@ -82,6 +90,8 @@ template <typename Archive,
 void CEREAL_LOAD_FUNCTION_NAME(
     Archive& ar, immer::vector<immer::box<T, MP>, MP, B, BL>& vector)
 {
+    if (lager::detail::load_shared_vector(ar, vector))
+        return;
     size_type size{};
     ar(make_size_tag(size));
 
@@ -0,0 +1,271 @@
+//
+// lager - library for functional interactive c++ programs
+// Copyright (C) 2017 Juan Pedro Bolivar Puente
+//
+// This file is part of lager.
+//
+// lager is free software: you can redistribute it and/or modify
+// it under the terms of the MIT License, as detailed in the LICENSE
+// file located at the root of this source code distribution,
+// or here: <https://github.com/arximboldi/lager/blob/master/LICENSE>
+//
+
+#pragma once
+
+#include <lager/config.hpp>
+
+#include <cereal/archives/adapters.hpp>
+#include <cereal/cereal.hpp>
+
+#include <immer/algorithm.hpp>
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace lager {
+
+/*!
+ * Keeps track of the `immer::box` values and the leaves of `immer::vector`
+ * and `immer::flex_vector` values that an archive has already written or
+ * read, so values that share structure are written only once.  Use it
+ * through a `lager::sharing_archive`:
+ *
+ * @code
+ * auto sharing = lager::structural_sharing{};
+ * auto ar = lager::sharing_archive<cereal::JSONOutputArchive>{sharing, os};
+ * ar(history);
+ * @endcode
+ *
+ * Every box and leaf is written the first time it is found, with an id that
+ * has its most significant bit set, as `cereal` does for `std::shared_ptr`.
+ * The next times only the id is written.  When reading, boxes are rebuilt
+ * sharing their value, and `immer::flex_vector` values are rebuilt by
+ * concatenating the leaves, so they share them again.  An `immer::vector` can
+ * not be concatenated, so its elements are copied one by one: it is still
+ * written only once, but the vectors that were read do not share memory.
+ */
+class structural_sharing
+{
+public:
+    static constexpr auto new_id = std::uint32_t{1} << 31;
+
+    /*!
+     * Returns the id for the data in `[ptr, ptr + size)`, with `new_id` set if
+     * this is the first time it was saved.  The `owner` keeps the data alive
+     * until the archive is done, so its address is not reused.
+     */
+    std::uint32_t save(const void* ptr,
+                       std::size_t size,
+                       const std::shared_ptr<const void>& owner)
+    {
+        auto [it, inserted] = saved_.emplace(std::make_pair(ptr, size),
+                                             std::uint32_t(saved_.size()));
+        if (!inserted)
+            return it->second;
+        owners_.push_back(owner);
+        return it->second | new_id;
+    }
+
+    /*!
+     * Reads the value for an `id` that has `new_id` set with `fn`, which
+     * returns a `std::shared_ptr` to it.  The id is reserved before calling
+     * `fn`, since the value may contain other values that are new too.
+     */
+    template <typename Fn>
+    void load(std::uint32_t id, Fn&& fn)
+    {
+        auto index = id & ~new_id;
+        if (index != loaded_.size())
+            LAGER_THROW(cereal::Exception{"invalid structural sharing id"});
+        loaded_.emplace_back();
+        loaded_[index] = std::forward<Fn>(fn)();
+    }
+
+    /*!
+     * Returns the value read with the given id.
+     */
+    template <typename T>
+    const T& loaded(std::uint32_t id) const
+    {
+        if (id >= loaded_.size())
+            LAGER_THROW(cereal::Exception{"invalid structural sharing id"});
+        return *std::static_pointer_cast<const T>(loaded_[id]);
+    }
+
+private:
+    std::map<std::pair<const void*, std::size_t>, std::uint32_t> saved_;
+    std::vector<std::shared_ptr<const void>> owners_;
+    std::vector<std::shared_ptr<const void>> loaded_;
+};
+
+/*!
+ * Archive that writes or reads `immer` values sharing their structure.
+ */
+template <typename Archive>
+using sharing_archive = cereal::UserDataAdapter<structural_sharing, Archive>;
+
+namespace detail {
+
+template <typename Archive>
+structural_sharing* get_structural_sharing(Archive& ar)
+{
+    auto adapter = dynamic_cast<sharing_archive<Archive>*>(&ar);
+    return adapter ? &adapter->userdata : nullptr;
+}
+
+template <typename Vector, typename Enable = void>
+struct is_concatenable : std::false_type
+{};
+
+template <typename Vector>
+struct is_concatenable<
+    Vector,
+    std::void_t<decltype(std::declval<Vector>() + std::declval<Vector>())>>
+    : std::true_type
+{};
+
+template <typename Vector>
+constexpr auto is_concatenable_v = is_concatenable<Vector>::value;
+
+template <typename T>
+struct shared_chunk_save
+{
+    const T* first;
+    const T* last;
+
+    template <typename Archive>
+    void CEREAL_SAVE_FUNCTION_NAME(Archive& ar) const
+    {
+        ar(cereal::make_size_tag(static_cast<cereal::size_type>(last - first)));
+        for (auto it = first; it != last; ++it)
+            ar(*it);
+    }
+};
+
+template <typename Vector>
+struct shared_chunk_load
+{
+    Vector& chunk;
+
+    template <typename Archive>
+    void CEREAL_LOAD_FUNCTION_NAME(Archive& ar)
+    {
+        auto size = cereal::size_type{};
+        ar(cereal::make_size_tag(size));
+        auto t = Vector{}.transient();
+        for (auto i = cereal::size_type{}; i < size; ++i) {
+            typename Vector::value_type x;
+            ar(x);
+            t.push_back(std::move(x));
+        }
+        chunk = std::move(t).persistent();
+    }
+};
+
+/*!
+ * Writes `vector` as a sequence of leaves when the archive shares structure,
+ * and returns whether it did.
+ */
+template <typename Archive, typename Vector>
+bool save_shared_vector(Archive& ar, const Vector& vector)
+{
+    using value_t = typename Vector::value_type;
+    auto sharing  = get_structural_sharing(ar);
+    if (!sharing)
+        return false;
+    auto owner  = std::make_shared<const Vector>(vector);
+    auto chunks = std::vector<std::pair<const value_t*, const value_t*>>{};
+    immer::for_each_chunk(vector, [&](auto first, auto last) {
+        chunks.emplace_back(first, last);
+    });
+    ar(cereal::make_size_tag(static_cast<cereal::size_type>(chunks.size())));
+    for (auto [first, last] : chunks) {
+        auto id = sharing->save(first, last - first, owner);
+        ar(id);
+        if (id & structural_sharing::new_id)
+            ar(shared_chunk_save<value_t>{first, last});
+    }
+    return true;
+}
+
+/*!
+ * Reads a `vector` written by `save_shared_vector()` when the archive shares
+ * structure, and returns whether it did.  Leaves are concatenated when the
+ * vector supports it, such that the result shares them.  Otherwise, as for
+ * `immer::vector`, the elements of every leaf are copied into the result.
+ */
+template <typename Archive, typename Vector>
+bool load_shared_vector(Archive& ar, Vector& vector)
+{
+    auto sharing = get_structural_sharing(ar);
+    if (!sharing)
+        return false;
+    auto count = cereal::size_type{};
+    ar(cereal::make_size_tag(count));
+    auto result = Vector{};
+    for (auto i = cereal::size_type{}; i < count; ++i) {
+        auto id = std::uint32_t{};
+        ar(id);
+        if (id & structural_sharing::new_id)
+            sharing->load(id, [&] {
+                auto chunk = std::make_shared<Vector>();
+                ar(shared_chunk_load<Vector>{*chunk});
+                return chunk;
+            });
+        auto& chunk =
+            sharing->template loaded<Vector>(id & ~structural_sharing::new_id);
+        if constexpr (is_concatenable_v<Vector>) {
+            result = std::move(result) + chunk;
+        } else {
+            auto t = std::move(result).transient();
+            for (auto& x : chunk)
+                t.push_back(x);
+            result = std::move(t).persistent();
+        }
+    }
+    vector = std::move(result);
+    return true;
+}
+
+/*!
+ * Writes the value of `box` only the first time it is found when the archive
+ * shares structure, and returns whether it did.
+ */
+template <typename Archive, typename Box>
+bool save_shared_box(Archive& ar, const Box& box)
+{
+    auto sharing = get_structural_sharing(ar);
+    if (!sharing)
+        return false;
+    auto id = sharing->save(&box.get(), 0, std::make_shared<const Box>(box));
+    ar(cereal::make_nvp("id", id));
+    if (id & structural_sharing::new_id)
+        ar(cereal::make_nvp("value", box.get()));
+    return true;
+}
+
+template <typename Archive, typename Box>
+bool load_shared_box(Archive& ar, Box& box)
+{
+    auto sharing = get_structural_sharing(ar);
+    if (!sharing)
+        return false;
+    auto id = std::uint32_t{};
+    ar(cereal::make_nvp("id", id));
+    if (id & structural_sharing::new_id)
+        sharing->load(id, [&] {
+            typename Box::value_type x;
+            ar(cereal::make_nvp("value", x));
+            return std::make_shared<const Box>(std::move(x));
+        });
+    box = sharing->template loaded<Box>(id & ~structural_sharing::new_id);
+    return true;
+}
+
+} // namespace detail
+
+} // namespace lager
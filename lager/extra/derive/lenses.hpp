@@ -0,0 +1,100 @@
+//
+// lager - library for functional interactive c++ programs
+// Copyright (C) 2017 Juan Pedro Bolivar Puente
+//
+// This file is part of lager.
+//
+// lager is free software: you can redistribute it and/or modify
+// it under the terms of the MIT License, as detailed in the LICENSE
+// file located at the root of this source code distribution,
+// or here: <https://github.com/arximboldi/lager/blob/master/LICENSE>
+//
+
+#pragma once
+
+#include <lager/util.hpp>
+
+#include <zug/compose.hpp>
+
+#include <boost/preprocessor/punctuation/remove_parens.hpp>
+#include <boost/preprocessor/seq/for_each.hpp>
+
+namespace lager {
+
+/*!
+ * Provides a lens for every member of a type `T` for which the `LENSES` facet
+ * was derived, as a static data member with the name of the member.  For
+ * example:
+ *
+ * @code
+ * LAGER_DERIVE((LENSES), ns, person, name, age);
+ *
+ * auto age = cursor[lager::field_lenses<ns::person>::age];
+ * @endcode
+ */
+template <typename T>
+struct field_lenses : T::lager_field_lenses
+{};
+
+namespace struct_detail {
+
+/*!
+ * Lens focusing on the member `ptr`.  Unlike `lenses::attr()`, the member is
+ * part of the type of the lens, which is stateless, so the compiler can
+ * always resolve the member access statically.
+ */
+template <typename Memptr, Memptr ptr>
+struct member_lens : zug::detail::pipeable
+{
+    template <typename F>
+    constexpr auto operator()(F&& f) const
+    {
+        return [f = std::forward<F>(f)](auto&& whole) {
+            return f(LAGER_FWD(whole).*ptr)([&](auto&& part) {
+                auto res = LAGER_FWD(whole);
+                res.*ptr = LAGER_FWD(part);
+                return res;
+            });
+        };
+    }
+};
+
+} // namespace struct_detail
+} // namespace lager
+
+#define LAGER_DERIVE_IMPL_LENSES_ITER__(r__, type__, elem__)                   \
+    static constexpr auto elem__ = ::lager::struct_detail::member_lens<        \
+        decltype(&BOOST_PP_REMOVE_PARENS(type__)::elem__),                     \
+        &BOOST_PP_REMOVE_PARENS(type__)::elem__>{};
+
+#define LAGER_DERIVE_IMPL_LENSES(r__, ns__, name__, members__)                 \
+    namespace lager {                                                          \
+    template <>                                                                \
+    struct field_lenses<ns__::name__>                                          \
+    {                                                                          \
+        BOOST_PP_SEQ_FOR_EACH_R(                                               \
+            r__, LAGER_DERIVE_IMPL_LENSES_ITER__, (ns__::name__), members__)   \
+    };                                                                         \
+    }                                                                          \
+    //
+
+#define LAGER_DERIVE_TEMPLATE_IMPL_LENSES(r__, ns__, tpl__, name__, members__) \
+    namespace lager {                                                          \
+    template <BOOST_PP_REMOVE_PARENS(tpl__)>                                   \
+    struct field_lenses<ns__::BOOST_PP_REMOVE_PARENS(name__)>                  \
+    {                                                                          \
+        BOOST_PP_SEQ_FOR_EACH_R(r__,                                           \
+                                LAGER_DERIVE_IMPL_LENSES_ITER__,               \
+                                (ns__::BOOST_PP_REMOVE_PARENS(name__)),        \
+                                members__)                                     \
+    };                                                                         \
+    }                                                                          \
+    //
+
+#define LAGER_DERIVE_NESTED_IMPL_LENSES(r__, name__, members__)                \
+    struct lager_field_lenses                                                  \
+    {                                                                          \
+        BOOST_PP_SEQ_FOR_EACH_R(                                               \
+            r__, LAGER_DERIVE_IMPL_LENSES_ITER__, (name__), members__)         \
+    };                                                                         \
+    //
@@ -0,0 +1,522 @@
+//
+// lager - library for functional interactive c++ programs
+// Copyright (C) 2017 Juan Pedro Bolivar Puente
+//
+// This file is part of lager.
+//
+// lager is free software: you can redistribute it and/or modify
+// it under the terms of the MIT License, as detailed in the LICENSE
+// file located at the root of this source code distribution,
+// or here: <https://github.com/arximboldi/lager/blob/master/LICENSE>
+//
+
+#pragma once
+
+#include <lager/config.hpp>
+#include <lager/effect.hpp>
+#include <lager/store.hpp>
+#include <lager/util.hpp>
+
+#include <cereal/archives/portable_binary.hpp>
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace lager {
+
+/*!
+ * Configures the snapshots taken by `lager::with_journal`.
+ */
+struct journal_snapshots
+{
+    //! Number of actions after which a new snapshot is taken.
+    std::size_t interval = 1024;
+};
+
+namespace detail {
+
+/*!
+ * A journal file starts with the number of actions that were compacted away
+ * from it, encoded in 8 bytes.  Then follows a record per action, made of its
+ * size in 4 bytes and the action serialized with the portable binary archive.
+ * A snapshot file is made of the number of actions it covers, encoded in 8
+ * bytes, followed by the serialized model.  Numbers are little-endian.
+ */
+constexpr auto journal_header_size = std::size_t{8};
+constexpr auto journal_record_size = std::size_t{4};
+
+inline void put_journal_number(std::string& buffer,
+                               std::uint64_t value,
+                               std::size_t size)
+{
+    for (auto i = std::size_t{}; i < size; ++i)
+        buffer.push_back(static_cast<char>((value >> (8 * i)) & 0xff));
+}
+
+inline std::uint64_t get_journal_number(const char* data, std::size_t size)
+{
+    auto value = std::uint64_t{};
+    for (auto i = std::size_t{}; i < size; ++i)
+        value |= std::uint64_t{static_cast<unsigned char>(data[i])} << (8 * i);
+    return value;
+}
+
+inline std::string read_journal_file(const std::string& path)
+{
+    auto is = std::ifstream{path, std::ios::binary};
+    return {std::istreambuf_iterator<char>{is},
+            std::istreambuf_iterator<char>{}};
+}
+
+/*!
+ * Writes `data` to `file` and makes sure it is on disk.  Returns whether it
+ * succeeded.
+ */
+inline bool write_journal_file(std::FILE* file, const std::string& data)
+{
+    if (std::fwrite(data.data(), 1, data.size(), file) != data.size() ||
+        std::fflush(file) != 0)
+        return false;
+#ifdef _WIN32
+    return ::_commit(::_fileno(file)) == 0;
+#else
+    return ::fsync(::fileno(file)) == 0;
+#endif
+}
+
+/*!
+ * Atomically replaces the file at `path` with `data`, making sure the data is
+ * on disk before it becomes visible.
+ */
+inline bool replace_journal_file(const std::string& path,
+                                 const std::string& data)
+{
+    auto tmp  = path + ".tmp";
+    auto file = std::fopen(tmp.c_str(), "wb");
+    if (!file)
+        return false;
+    auto written = write_journal_file(file, data);
+    if (std::fclose(file) != 0 || !written) {
+        std::remove(tmp.c_str());
+        return false;
+    }
+    auto ec = std::error_code{};
+    std::filesystem::rename(tmp, path, ec);
+    return !ec;
+}
+
+/*!
+ * Offsets of the records of a journal that were completely written, which
+ * may not be all of them when the program stopped in the middle of a write.
+ */
+struct journal_index
+{
+    std::uint64_t base = 0;
+    std::vector<std::size_t> offsets;
+    std::size_t end = 0;
+
+    journal_index(const std::string& data)
+    {
+        if (data.size() < journal_header_size)
+            return;
+        base = get_journal_number(data.data(), journal_header_size);
+        end  = journal_header_size;
+        while (data.size() - end >= journal_record_size) {
+            auto size =
+                get_journal_number(data.data() + end, journal_record_size);
+            if (data.size() - end - journal_record_size < size)
+                break;
+            offsets.push_back(end);
+            end += journal_record_size + size;
+        }
+    }
+
+    std::uint64_t count() const { return base + offsets.size(); }
+};
+
+/*!
+ * Calls `fn` with every action in the journal at `path` after the first
+ * `from` ones, in the order they were written.  Returns the size of the
+ * prefix of the file made of complete records and the total number of actions
+ * in it.  A record that was not completely written, because the program
+ * stopped in the middle of a write, ends the journal.  A complete record that
+ * can not be decoded means that the journal is corrupt or was written for
+ * other actions, and raises an error instead, since the records after it were
+ * already on disk and dropping them would lose data.
+ */
+template <typename Action, typename Fn>
+std::pair<std::size_t, std::uint64_t>
+read_journal(const std::string& path, std::uint64_t from, Fn&& fn)
+{
+    auto data  = read_journal_file(path);
+    auto index = journal_index{data};
+    if (index.base > from || (!data.empty() && index.count() < from))
+        LAGER_THROW(std::runtime_error{
+            "journal does not match the snapshot: " + path});
+    for (auto i = std::size_t{}; i < index.offsets.size(); ++i) {
+        if (index.base + i < from)
+            continue;
+        auto offset = index.offsets[i] + journal_record_size;
+        auto size   = get_journal_number(data.data() + index.offsets[i],
+                                       journal_record_size);
+        auto action  = Action{};
+        auto decoded = false;
+        LAGER_TRY {
+            auto rs = std::istringstream{data.substr(offset, size)};
+            auto ar = cereal::PortableBinaryInputArchive{rs};
+            ar(action);
+            decoded = rs.peek() == std::istringstream::traits_type::eof();
+        }
+        LAGER_CATCH(const cereal::Exception&) {}
+        if (!decoded)
+            LAGER_THROW(std::runtime_error{
+                "corrupt journal record " + std::to_string(index.base + i) +
+                ": " + path});
+        fn(std::move(action));
+    }
+    return {index.end, std::max(from, index.count())};
+}
+
+/*!
+ * Loads the snapshot at `path` into `model`, and returns the number of actions
+ * it covers, or zero when there is no snapshot.
+ */
+template <typename Model>
+std::uint64_t read_snapshot(const std::string& path, Model& model)
+{
+    if (!std::filesystem::exists(path))
+        return 0;
+    auto data = read_journal_file(path);
+    if (data.size() < journal_header_size)
+        LAGER_THROW(std::runtime_error{"invalid snapshot: " + path});
+    auto is = std::istringstream{data.substr(journal_header_size)};
+    auto ar = cereal::PortableBinaryInputArchive{is};
+    ar(model);
+    return get_journal_number(data.data(), journal_header_size);
+}
+
+/*!
+ * Appends actions to a journal file.  Actions are queued by the reducer
+ * thread, and serialized and written by a background thread.  All the actions
+ * that were queued while the previous batch was being written are written
+ * together and synced to disk with a single `fsync()`.
+ *
+ * The background thread also writes the snapshots.  Once a snapshot is on
+ * disk, the journal is rewritten without the actions that the snapshot
+ * covers.  The journal only forgets them once the new one replaced it, and
+ * if that fails writing stops as when a batch can not be written.
+ */
+template <typename Action>
+class journal_writer
+{
+public:
+    journal_writer(const std::string& path, std::uint64_t count)
+        : path_{path}
+        , snapshot_path_{path + ".snapshot"}
+        , count_{count}
+        , last_snapshot_{count}
+    {
+        if (!std::filesystem::exists(path) ||
+            std::filesystem::file_size(path) == 0) {
+            auto header = std::string{};
+            put_journal_number(header, count, journal_header_size);
+            if (!replace_journal_file(path, header))
+                LAGER_THROW(
+                    std::runtime_error{"could not create journal: " + path});
+            base_ = count;
+        } else {
+            base_ = journal_index{read_journal_file(path)}.base;
+        }
+        file_ = std::fopen(path.c_str(), "ab");
+        if (!file_)
+            LAGER_THROW(std::runtime_error{"could not open journal: " + path});
+        thread_ = std::thread{[this] { run(); }};
+    }
+
+    journal_writer(const journal_writer&) = delete;
+    journal_writer& operator=(const journal_writer&) = delete;
+
+    ~journal_writer()
+    {
+        {
+            auto lock = std::lock_guard<std::mutex>{mutex_};
+            done_     = true;
+        }
+        cv_.notify_one();
+        thread_.join();
+        if (file_)
+            std::fclose(file_);
+    }
+
+    /*!
+     * Queues an action.  Must be called from the reducer thread.  Throws if
+     * writing a previous batch failed, in which case nothing else is written.
+     */
+    void append(const Action& action)
+    {
+        {
+            auto lock = std::lock_guard<std::mutex>{mutex_};
+            if (!error_.empty())
+                LAGER_THROW(std::runtime_error{error_});
+            pending_.push_back(action);
+        }
+        ++count_;
+        cv_.notify_one();
+    }
+
+    /*!
+     * Queues a snapshot of `model` if at least `interval` actions were
+     * appended since the last one.  The `model` must be the result of all
+     * the actions appended so far, and it is serialized in the background.
+     * Must be called from the reducer thread.
+     */
+    template <typename Model>
+    void snapshot(const Model& model, std::size_t interval)
+    {
+        if (count_ - last_snapshot_ < interval)
+            return;
+        last_snapshot_ = count_;
+        {
+            auto lock      = std::lock_guard<std::mutex>{mutex_};
+            snapshot_seq_  = count_;
+            snapshot_save_ = [model](std::ostream& os) {
+                auto ar = cereal::PortableBinaryOutputArchive{os};
+                ar(model);
+            };
+        }
+        cv_.notify_one();
+    }
+
+private:
+    using snapshot_save_t = std::function<void(std::ostream&)>;
+
+    void run()
+    {
+        auto batch = std::vector<Action>{};
+        while (true) {
+            auto save = snapshot_save_t{};
+            auto seq  = std::uint64_t{};
+            {
+                auto lock = std::unique_lock<std::mutex>{mutex_};
+                cv_.wait(lock, [&] {
+                    return done_ || !pending_.empty() || snapshot_save_;
+                });
+                if (pending_.empty() && !snapshot_save_)
+                    return;
+                std::swap(batch, pending_);
+                std::swap(save, snapshot_save_);
+                seq = snapshot_seq_;
+            }
+            if (!batch.empty()) {
+                write(batch);
+                batch.clear();
+            }
+            if (save)
+                write_snapshot(save, seq);
+        }
+    }
+
+    void write(const std::vector<Action>& batch)
+    {
+        auto buffer = std::string{};
+        for (auto& action : batch) {
+            auto os = std::ostringstream{};
+            {
+                auto ar = cereal::PortableBinaryOutputArchive{os};
+                ar(action);
+            }
+            auto record = std::move(os).str();
+            put_journal_number(buffer, record.size(), journal_record_size);
+            buffer += record;
+        }
+        if (file_ && !write_journal_file(file_, buffer))
+            fail("could not write journal: " + path_);
+    }
+
+    // Stops writing, since a partially written batch would leave a gap in
+    // the journal, and reports `error` to the reducer thread.
+    void fail(std::string error)
+    {
+        if (file_) {
+            std::fclose(file_);
+            file_ = nullptr;
+        }
+        auto lock = std::lock_guard<std::mutex>{mutex_};
+        error_    = std::move(error);
+    }
+
+    void write_snapshot(const snapshot_save_t& save, std::uint64_t seq)
+    {
+        auto data = std::string{};
+        put_journal_number(data, seq, journal_header_size);
+        {
+            auto os = std::ostringstream{};
+            save(os);
+            data += std::move(os).str();
+        }
+        if (!replace_journal_file(snapshot_path_, data))
+            return fail("could not write snapshot: " + snapshot_path_);
+        compact(seq);
+    }
+
+    void compact(std::uint64_t seq)
+    {
+        if (!file_ || seq <= base_)
+            return;
+        auto data  = read_journal_file(path_);
+        auto index = journal_index{data};
+        auto drop  = static_cast<std::size_t>(seq - index.base);
+        auto rest  = drop < index.offsets.size() ? index.offsets[drop]
+                                                 : index.end;
+        auto compacted = std::string{};
+        put_journal_number(compacted, seq, journal_header_size);
+        compacted.append(data, rest, index.end - rest);
+        std::fclose(file_);
+        file_ = nullptr;
+        if (!replace_journal_file(path_, compacted))
+            return fail("could not compact journal: " + path_);
+        file_ = std::fopen(path_.c_str(), "ab");
+        if (!file_)
+            return fail("could not open journal: " + path_);
+        base_ = seq;
+    }
+
+    std::string path_;
+    std::string snapshot_path_;
+
+    // only accessed by the reducer thread
+    std::uint64_t count_;
+    std::uint64_t last_snapshot_;
+
+    // only accessed by the background thread
+    std::FILE* file_    = nullptr;
+    std::uint64_t base_ = 0;
+
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::vector<Action> pending_;
+    snapshot_save_t snapshot_save_;
+    std::uint64_t snapshot_seq_ = 0;
+    bool done_                  = false;
+    std::string error_;
+    std::thread thread_;
+};
+
+template <bool Snapshots>
+auto make_journal_enhancer(std::string path, journal_snapshots snapshots)
+{
+    return [path = std::move(path), snapshots](auto next) {
+        return [path, snapshots, next](auto action,
+                                       auto&& model,
+                                       auto&& reducer,
+                                       auto&& loop,
+                                       auto&& deps,
+                                       auto&& tags) {
+            using action_t  = typename decltype(action)::type;
+            using model_t   = std::decay_t<decltype(model)>;
+            using deps_t    = std::decay_t<decltype(deps)>;
+            using reducer_t = std::decay_t<decltype(reducer)>;
+            using writer_t  = journal_writer<action_t>;
+            auto state      = model_t{LAGER_FWD(model)};
+            auto from       = std::uint64_t{};
+            if constexpr (Snapshots)
+                from = read_snapshot(path + ".snapshot", state);
+            auto [valid, count] =
+                read_journal<action_t>(path, from, [&](action_t&& act) {
+                    state = invoke_reducer<deps_t>(
+                        reducer, std::move(state), act, [](auto&&) {}, [] {});
+                });
+            if (std::filesystem::exists(path) &&
+                std::filesystem::file_size(path) > valid)
+                std::filesystem::resize_file(path, valid);
+            auto journal = std::make_shared<writer_t>(path, count);
+            auto store   = next(
+                action,
+                std::move(state),
+                [journal, reducer = reducer_t{LAGER_FWD(reducer)}](
+                    auto&& model, auto&& action) -> decltype(auto) {
+                    journal->append(action);
+                    return std::invoke(
+                        reducer, LAGER_FWD(model), LAGER_FWD(action));
+                },
+                LAGER_FWD(loop),
+                LAGER_FWD(deps),
+                LAGER_FWD(tags));
+            if constexpr (Snapshots)
+                watch(store, [journal, interval = snapshots.interval](
+                                 const model_t& m) {
+                    journal->snapshot(m, interval);
+                });
+            return store;
+        };
+    };
+}
+
+} // namespace detail
+
+/*!
+ * Store enhancer that records every action processed by the store in an
+ * append-only journal file at `path`, serialized with `cereal`.  When the
+ * store is created, the model is rebuilt by passing the actions already in
+ * the journal through the reducer, without evaluating their effects---the
+ * actions dispatched by those effects were journaled themselves.
+ *
+ * The reducer thread only queues the actions: they are serialized and written
+ * in batches by a background thread, which syncs each batch to disk at once.
+ * Actions that were still queued when the store is destroyed are written
+ * before the destructor returns, but the ones queued right before a crash may
+ * be lost.  When writing fails, the journal stops growing and the next
+ * dispatched action throws a `std::runtime_error`.  Creating the store also
+ * throws when the journal contains a complete record that can not be decoded,
+ * while a record that was only partially written is discarded.
+ *
+ * @note Actions are recorded as they reach the reducer, in the order they are
+ *       processed.  Enhancers that replace the reducer, like
+ *       `lager::with_reducer`, must be placed before this one.
+ */
+inline auto with_journal(std::string path)
+{
+    return detail::make_journal_enhancer<false>(std::move(path), {});
+}
+
+/*!
+ * Like `with_journal(path)`, but also saves snapshots of the model to
+ * `path + ".snapshot"`, so the journal does not grow indefinitely.  Whenever
+ * the store notifies its watchers and `snapshots.interval` actions were
+ * processed since the last snapshot, the model is serialized in the
+ * background, and then the actions it covers are removed from the journal.
+ * When the store is created, the latest snapshot is loaded and only the
+ * actions after it are replayed.  Failing to write a snapshot or to rewrite
+ * the journal is reported like any other write error, leaving both files as
+ * they were.
+ *
+ * @note The model needs to be serializable with `cereal`.
+ */
+inline auto with_journal(std::string path, journal_snapshots snapshots)
+{
+    return detail::make_journal_enhancer<true>(std::move(path), snapshots);
+}
+
+} // namespace lager
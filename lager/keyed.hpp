@@ -0,0 +1,612 @@
+//
+// lager - library for functional interactive c++ programs
+// Copyright (C) 2017 Juan Pedro Bolivar Puente
+//
+// This file is part of lager.
+//
+// lager is free software: you can redistribute it and/or modify
+// it under the terms of the MIT License, as detailed in the LICENSE
+// file located at the root of this source code distribution,
+// or here: <https://github.com/arximboldi/lager/blob/master/LICENSE>
+//
+
+#pragma once
+
+#include <lager/detail/immer_traits.hpp>
+#include <lager/detail/lookup.hpp>
+#include <lager/detail/sequence.hpp>
+#include <lager/cursor.hpp>
+#include <lager/reader.hpp>
+#include <lager/util.hpp>
+
+#include <immer/algorithm.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace lager {
+
+namespace detail {
+
+/*!
+ * Type of the keys of a container: the `key_type` of associative containers,
+ * or a position for sequences.
+ */
+template <typename Container, typename = void>
+struct container_key
+{
+    using type = std::size_t;
+};
+
+template <typename Container>
+struct container_key<Container, std::void_t<typename Container::key_type>>
+{
+    using type = typename Container::key_type;
+};
+
+template <typename Container>
+using container_key_t = typename container_key<Container>::type;
+
+template <typename Container, typename = void>
+struct container_hasher
+{
+    using type = std::hash<container_key_t<Container>>;
+};
+
+template <typename Container>
+struct container_hasher<Container, std::void_t<typename Container::hasher>>
+{
+    using type = typename Container::hasher;
+};
+
+template <typename Container>
+using container_hasher_t = typename container_hasher<Container>::type;
+
+template <typename Container>
+using container_mapped_t = std::decay_t<decltype(*lookup(
+    std::declval<const Container&>(),
+    std::declval<const container_key_t<Container>&>()))>;
+
+/*!
+ * Calls `fn` with the keys that are in `keys` and whose value differs between
+ * `old` and `next`, including keys that were added or removed.  For
+ * `immer::map` this diffs the containers structurally, visiting only the parts
+ * of the trees that are not shared among them.  For other containers, every
+ * key in `keys` is looked up in both containers.
+ */
+template <typename Container, typename Keys, typename Fn>
+void for_each_changed_key(const Container& old,
+                          const Container& next,
+                          const Keys& keys,
+                          Fn&& fn)
+{
+    if constexpr (is_immer_map_v<Container>) {
+        immer::diff(old,
+                    next,
+                    immer::make_differ(
+                        [&](auto&& added) { fn(added.first); },
+                        [&](auto&& removed) { fn(removed.first); },
+                        [&](auto&&, auto&& changed) { fn(changed.first); }));
+    } else {
+        for (auto& entry : keys) {
+            auto& key = entry.first;
+            auto a    = lookup(old, key);
+            auto b    = lookup(next, key);
+            if (a != b && (!a || !b || has_changed(*a, *b)))
+                fn(key);
+        }
+    }
+}
+
+/*!
+ * Keeps the nodes that watch individual keys of a container.  It is linked as
+ * the only regular child of the container node `Node`, and forwards the
+ * propagation only to the nodes whose key changed, as reported by
+ * `Node::for_each_changed_key()`.
+ */
+template <typename Node, typename Key, typename Child, typename Hash>
+class key_fan_out : public reader_node_base
+{
+    using children_t = std::vector<std::weak_ptr<Child>>;
+
+    Node* node_;
+    std::unordered_map<Key, children_t, Hash> keys_;
+    std::vector<std::weak_ptr<Child>> pending_notify_;
+
+public:
+    key_fan_out(Node* node)
+        : node_{node}
+    {}
+
+    const std::unordered_map<Key, children_t, Hash>& keys() const
+    {
+        return keys_;
+    }
+
+    void add(const Key& key, std::weak_ptr<Child> child)
+    {
+        auto& children = keys_[key];
+        collect_(children);
+        children.push_back(std::move(child));
+    }
+
+    void send_down() final
+    {
+        auto garbage = std::vector<Key>{};
+        node_->for_each_changed_key([&](const Key& key) {
+            auto it = keys_.find(key);
+            if (it == keys_.end())
+                return;
+            collect_(it->second);
+            if (it->second.empty())
+                garbage.push_back(key);
+            for (auto& wchild : it->second) {
+                if (auto child = wchild.lock()) {
+                    child->send_down();
+                    pending_notify_.push_back(child);
+                }
+            }
+        });
+        for (auto& key : garbage)
+            keys_.erase(key);
+    }
+
+    void notify() final
+    {
+        auto pending = std::move(pending_notify_);
+        pending_notify_.clear();
+        for (auto& wchild : pending)
+            if (auto child = wchild.lock())
+                child->notify();
+    }
+
+private:
+    static void collect_(children_t& children)
+    {
+        using namespace std;
+        children.erase(remove_if(begin(children),
+                                 end(children),
+                                 mem_fn(&weak_ptr<Child>::expired)),
+                       end(children));
+    }
+};
+
+template <typename ParentT>
+class keyed_node;
+
+/*!
+ * Node with the value at a given key of the container in a `keyed_node`.
+ */
+template <typename ParentT>
+class keyed_child_node
+    : public inner_node<
+          std::optional<container_mapped_t<zug::meta::value_t<ParentT>>>,
+          zug::meta::pack<keyed_node<ParentT>>,
+          reader_node>
+{
+    using container_t = zug::meta::value_t<ParentT>;
+    using key_t       = container_key_t<container_t>;
+    using base_t      = inner_node<
+        std::optional<container_mapped_t<zug::meta::value_t<ParentT>>>,
+        zug::meta::pack<keyed_node<ParentT>>,
+        reader_node>;
+
+    key_t key_;
+
+public:
+    using value_type = typename base_t::value_type;
+
+    keyed_child_node(key_t key, std::shared_ptr<keyed_node<ParentT>> parent)
+        : base_t{view_(parent->current(), key), std::make_tuple(parent)}
+        , key_{std::move(key)}
+    {}
+
+    void recompute() final
+    {
+        this->push_down(view_(std::get<0>(this->parents())->current(), key_));
+    }
+
+private:
+    static value_type view_(const container_t& c, const key_t& key)
+    {
+        auto p = lookup(c, key);
+        return p ? value_type{*p} : value_type{};
+    }
+};
+
+/*!
+ * Node that fans out a container to nodes watching individual keys of it.
+ * Instead of sending every change down to all of them, it finds out which
+ * keys changed and only sends down to the nodes watching those keys.
+ */
+template <typename ParentT>
+class keyed_node
+    : public inner_node<zug::meta::value_t<ParentT>,
+                        zug::meta::pack<ParentT>,
+                        reader_node>
+{
+    using base_t      = inner_node<zug::meta::value_t<ParentT>,
+                              zug::meta::pack<ParentT>,
+                              reader_node>;
+    using container_t = zug::meta::value_t<ParentT>;
+    using key_t       = container_key_t<container_t>;
+    using child_t     = keyed_child_node<ParentT>;
+    using fan_out_t   = key_fan_out<keyed_node,
+                                  key_t,
+                                  child_t,
+                                  container_hasher_t<container_t>>;
+
+    std::shared_ptr<fan_out_t> fan_out_ = std::make_shared<fan_out_t>(this);
+    container_t dispatched_;
+
+public:
+    using value_type = container_t;
+
+    keyed_node(std::shared_ptr<ParentT> parent)
+        : base_t{parent->current(), std::make_tuple(parent)}
+        , dispatched_{parent->current()}
+    {}
+
+    void recompute() final
+    {
+        this->push_down(std::get<0>(this->parents())->current());
+    }
+
+    void link_fan_out() { this->link(fan_out_); }
+
+    std::shared_ptr<child_t> child(std::shared_ptr<keyed_node> self, key_t key)
+    {
+        auto n = std::make_shared<child_t>(key, std::move(self));
+        fan_out_->add(key, n);
+        return n;
+    }
+
+    template <typename Fn>
+    void for_each_changed_key(Fn&& fn)
+    {
+        auto& next = this->last();
+        ::lager::detail::for_each_changed_key(
+            dispatched_, next, fan_out_->keys(), fn);
+        dispatched_ = next;
+    }
+};
+
+template <typename ParentT>
+auto make_keyed_node(std::shared_ptr<ParentT> parent)
+{
+    auto n = std::make_shared<keyed_node<ParentT>>(parent);
+    parent->link(n);
+    n->link_fan_out();
+    return n;
+}
+
+template <typename ParentT, typename KeyFn>
+class keyed_by_node;
+
+/*!
+ * Node with the element with a given key of the sequence in a
+ * `keyed_by_node`.  Writing an empty value removes the element, and writing a
+ * value for a key that is not in the sequence adds it at the end.
+ */
+template <typename ParentT, typename KeyFn>
+class keyed_by_child_node
+    : public inner_node<
+          std::optional<typename zug::meta::value_t<ParentT>::value_type>,
+          zug::meta::pack<keyed_by_node<ParentT, KeyFn>>,
+          cursor_node>
+{
+    using parent_t = keyed_by_node<ParentT, KeyFn>;
+    using key_t    = typename parent_t::key_t;
+    using base_t   = inner_node<
+        std::optional<typename zug::meta::value_t<ParentT>::value_type>,
+        zug::meta::pack<parent_t>,
+        cursor_node>;
+
+    key_t key_;
+
+public:
+    using value_type = typename base_t::value_type;
+
+    keyed_by_child_node(key_t key, std::shared_ptr<parent_t> parent)
+        : base_t{view_(*parent, key), std::make_tuple(parent)}
+        , key_{std::move(key)}
+    {}
+
+    void recompute() final
+    {
+        this->push_down(view_(*std::get<0>(this->parents()), key_));
+    }
+
+    void send_up(const value_type& value) final
+    {
+        if (this->batch_send_up(value))
+            return;
+        this->refresh();
+        this->push_up(std::get<0>(this->parents())->updated(key_, value));
+    }
+
+    void send_up(value_type&& value) final
+    {
+        if (this->batch_send_up(std::move(value)))
+            return;
+        this->refresh();
+        this->push_up(
+            std::get<0>(this->parents())->updated(key_, std::move(value)));
+    }
+
+private:
+    static value_type view_(parent_t& parent, const key_t& key)
+    {
+        auto p = parent.find(key);
+        return p ? value_type{*p} : value_type{};
+    }
+};
+
+/*!
+ * Node that fans out a sequence to nodes watching the elements with a given
+ * key, as extracted from the elements by `KeyFn`.  These nodes follow their
+ * element when other elements are inserted or removed before it, and only
+ * receive changes when their element changes.
+ */
+template <typename ParentT, typename KeyFn>
+class keyed_by_node
+    : public inner_node<zug::meta::value_t<ParentT>,
+                        zug::meta::pack<ParentT>,
+                        cursor_node>
+{
+    using base_t      = inner_node<zug::meta::value_t<ParentT>,
+                              zug::meta::pack<ParentT>,
+                              cursor_node>;
+    using container_t = zug::meta::value_t<ParentT>;
+    using element_t   = typename container_t::value_type;
+
+public:
+    using key_t =
+        std::decay_t<std::invoke_result_t<KeyFn&, const element_t&>>;
+
+private:
+    using child_t = keyed_by_child_node<ParentT, KeyFn>;
+    using fan_out_t =
+        key_fan_out<keyed_by_node, key_t, child_t, std::hash<key_t>>;
+
+    static constexpr auto no_epoch = std::numeric_limits<std::uint64_t>::max();
+
+    KeyFn key_fn_;
+    std::shared_ptr<fan_out_t> fan_out_ = std::make_shared<fan_out_t>(this);
+    container_t dispatched_;
+    // position of every key in `indexed_`
+    std::unordered_map<key_t, std::size_t> index_;
+    container_t indexed_;
+    std::uint64_t index_epoch_ = no_epoch;
+
+public:
+    using value_type = container_t;
+
+    keyed_by_node(std::shared_ptr<ParentT> parent, KeyFn key_fn)
+        : base_t{parent->current(), std::make_tuple(parent)}
+        , key_fn_{std::move(key_fn)}
+        , dispatched_{parent->current()}
+    {}
+
+    void recompute() final
+    {
+        this->push_down(std::get<0>(this->parents())->current());
+    }
+
+    void send_up(const value_type& value) final
+    {
+        if (!this->batch_send_up(value))
+            this->push_up(value);
+    }
+
+    void send_up(value_type&& value) final
+    {
+        if (!this->batch_send_up(std::move(value)))
+            this->push_up(std::move(value));
+    }
+
+    void link_fan_out() { this->link(fan_out_); }
+
+    std::shared_ptr<child_t> child(std::shared_ptr<keyed_by_node> self,
+                                   key_t key)
+    {
+        auto n = std::make_shared<child_t>(key, std::move(self));
+        fan_out_->add(key, n);
+        return n;
+    }
+
+    /*!
+     * Returns the element with the given key in the current sequence, or
+     * `nullptr` if there is none.
+     */
+    const element_t* find(const key_t& key)
+    {
+        auto pos = position_(key);
+        return pos ? std::addressof(this->current()[*pos]) : nullptr;
+    }
+
+    /*!
+     * Returns the current sequence, with the element with the given key
+     * replaced by `value`.
+     */
+    template <typename T>
+    container_t updated(const key_t& key, T&& value)
+    {
+        auto pos = position_(key);
+        if (value)
+            return pos ? replace_at(this->current(), *pos, *LAGER_FWD(value))
+                       : push_back(this->current(), *LAGER_FWD(value));
+        else
+            return pos ? erase_at(this->current(), *pos) : this->current();
+    }
+
+    /*!
+     * Calls `fn` with the keys of the elements that changed since the last
+     * call.  Only the elements between the common prefix and suffix of the
+     * old and new sequences are considered.
+     */
+    template <typename Fn>
+    void for_each_changed_key(Fn&& fn)
+    {
+        auto& old             = dispatched_;
+        auto& next            = this->last();
+        auto [prefix, suffix] = common_ends(old, next);
+
+        auto removed = std::unordered_map<key_t, const element_t*>{};
+        for (auto i = prefix, e = old.size() - suffix; i < e; ++i)
+            removed.emplace(key_fn_(old[i]), std::addressof(old[i]));
+        for (auto i = prefix, e = next.size() - suffix; i < e; ++i) {
+            auto key = key_fn_(next[i]);
+            auto it  = removed.find(key);
+            if (it == removed.end()) {
+                fn(key);
+            } else {
+                if (!same_element(*it->second, next[i]))
+                    fn(key);
+                removed.erase(it);
+            }
+        }
+        for (auto& entry : removed)
+            fn(entry.first);
+        dispatched_ = next;
+    }
+
+private:
+    std::optional<std::size_t> position_(const key_t& key)
+    {
+        if (index_epoch_ != this->changed_epoch()) {
+            reindex_();
+            index_epoch_ = this->changed_epoch();
+        }
+        auto it = index_.find(key);
+        return it == index_.end() ? std::nullopt
+                                  : std::optional<std::size_t>{it->second};
+    }
+
+    // Updates the index with the elements between the common ends of the
+    // indexed and current sequences.  The elements after them only need to
+    // be updated when they moved, because elements were inserted or removed.
+    void reindex_()
+    {
+        auto& old             = indexed_;
+        auto& next            = this->current();
+        auto [prefix, suffix] = common_ends(old, next);
+        auto old_end          = old.size() - suffix;
+        auto next_end         = next.size() - suffix;
+        for (auto i = prefix; i < old_end; ++i)
+            index_.erase(key_fn_(old[i]));
+        auto last = old_end == next_end ? next_end : next.size();
+        for (auto i = prefix; i < last; ++i)
+            index_[key_fn_(next[i])] = i;
+        indexed_ = next;
+    }
+};
+
+template <typename ParentT, typename KeyFn>
+auto make_keyed_by_node(std::shared_ptr<ParentT> parent, KeyFn&& key_fn)
+{
+    auto n = std::make_shared<keyed_by_node<ParentT, std::decay_t<KeyFn>>>(
+        parent, std::forward<KeyFn>(key_fn));
+    parent->link(n);
+    n->link_fan_out();
+    return n;
+}
+
+} // namespace detail
+
+//! @defgroup cursors
+//! @{
+
+/*!
+ * Reader of a container that provides readers for the values at individual
+ * keys.  Unlike `reader[key]`, which looks up its key whenever the container
+ * changes, the readers obtained from a `keyed_reader` are only updated when
+ * the value at their key changes.  For `immer::map` the changed keys are
+ * found by diffing the old and new containers, so a change to one element
+ * costs `O(log N)` instead of `O(N)`.
+ *
+ * @note The readers for the individual keys have type `std::optional<T>`, and
+ *       are empty when the key is not in the container.
+ */
+template <typename ParentT>
+class keyed_reader : public reader_base<detail::keyed_node<ParentT>>
+{
+    using base_t   = reader_base<detail::keyed_node<ParentT>>;
+    using key_t    = detail::container_key_t<zug::meta::value_t<ParentT>>;
+    using mapped_t = detail::container_mapped_t<zug::meta::value_t<ParentT>>;
+
+public:
+    using base_t::base_t;
+
+    reader<std::optional<mapped_t>> operator[](key_t key) const
+    {
+        auto node = detail::access::node(*this);
+        return node->child(node, std::move(key));
+    }
+};
+
+/*!
+ * Cursor of a sequence that provides cursors for the elements with a given
+ * key, as extracted from the elements by a `KeyFn`.  The cursors for the
+ * individual keys follow their element when it moves within the sequence,
+ * and are only updated when their element changes.  This way, inserting or
+ * removing elements does not invalidate the cursors for the rest of them.
+ *
+ * @note The cursors for the individual keys have type `std::optional<T>`,
+ *       and are empty when no element has the key.  Setting them to an empty
+ *       value removes the element, and setting a value when no element has the
+ *       key adds it at the end of the sequence.
+ */
+template <typename ParentT, typename KeyFn>
+class keyed_cursor : public cursor_base<detail::keyed_by_node<ParentT, KeyFn>>
+{
+    using base_t    = cursor_base<detail::keyed_by_node<ParentT, KeyFn>>;
+    using key_t     = typename detail::keyed_by_node<ParentT, KeyFn>::key_t;
+    using element_t = typename zug::meta::value_t<ParentT>::value_type;
+
+public:
+    using base_t::base_t;
+
+    cursor<std::optional<element_t>> operator[](key_t key) const
+    {
+        auto node = detail::access::node(*this);
+        return node->child(node, std::move(key));
+    }
+};
+
+/*!
+ * Returns a `keyed_reader` for the container in the reader or cursor `r`.
+ */
+template <typename ReaderT>
+auto keyed(ReaderT&& r)
+{
+    auto parent = detail::access::node(std::forward<ReaderT>(r).make());
+    using parent_t = typename decltype(parent)::element_type;
+    return keyed_reader<parent_t>{detail::make_keyed_node(std::move(parent))};
+}
+
+/*!
+ * Returns a `keyed_cursor` for the sequence in the cursor `c`, identifying
+ * its elements by the key returned by `key_fn`.  Keys must be unique within
+ * the sequence.
+ */
+template <typename CursorT, typename KeyFn>
+auto keyed(CursorT&& c, KeyFn&& key_fn)
+{
+    auto parent = detail::access::node(std::forward<CursorT>(c).make());
+    using parent_t = typename decltype(parent)::element_type;
+    return keyed_cursor<parent_t, std::decay_t<KeyFn>>{
+        detail::make_keyed_by_node(std::move(parent),
+                                   std::forward<KeyFn>(key_fn))};
+}
+
+//! @}
+
+} // namespace lager
@@ -1,7 +1,10 @@
 #pragma once
 
 #include <lager/lenses.hpp>
+
+#include <cstddef>
 #include <memory>
+#include <new>
 #include <type_traits>
 #include <utility>
 
@@ -9,29 +12,67 @@ namespace lager {
 namespace detail {
 
 template <typename Whole, typename Part>
-struct lens_i
+struct lens_vtable
 {
-    virtual ~lens_i()                                  = default;
-    virtual Part view(Whole const&) const              = 0;
-    virtual Whole set(Whole const&, Part const&) const = 0;
+    Part (*view)(const void* self, Whole const&);
+    Whole (*set)(const void* self, Whole const&, Part const&);
+    void (*copy)(const void* self, void* dst);
+    void (*move)(void* self, void* dst) noexcept;
+    void (*destroy)(void* self) noexcept;
 };
 
-template <typename Lens, typename Whole, typename Part>
-struct lens_holder : public lens_i<Whole, Part>
+template <typename Lens>
+const Lens& deref_lens(const Lens& x)
 {
-    Lens value;
+    return x;
+}
 
-    template <typename T>
-    lens_holder(T&& other)
-        : value{std::forward<T>(other)}
-    {}
+template <typename Lens>
+const Lens& deref_lens(const std::shared_ptr<const Lens>& x)
+{
+    return *x;
+}
+
+/*!
+ * Implements the operations of a `lens_vtable` for a lens stored as `Stored`
+ * in the buffer of a `lager::lens`.  `Stored` is either the lens itself or,
+ * for lenses too big for the buffer, a `std::shared_ptr` to it.
+ */
+template <typename Stored, typename Whole, typename Part>
+struct lens_model
+{
+    static const Stored& get(const void* self)
+    {
+        return *static_cast<const Stored*>(self);
+    }
+
+    static Part view(const void* self, Whole const& w)
+    {
+        return ::lager::view(deref_lens(get(self)), w);
+    }
 
-    Part view(Whole const& w) const override { return ::lager::view(value, w); }
+    static Whole set(const void* self, Whole const& w, Part const& p)
+    {
+        return ::lager::set(deref_lens(get(self)), w, p);
+    }
+
+    static void copy(const void* self, void* dst)
+    {
+        new (dst) Stored(get(self));
+    }
 
-    Whole set(Whole const& w, Part const& p) const override
+    static void move(void* self, void* dst) noexcept
     {
-        return ::lager::set(value, w, p);
+        new (dst) Stored(std::move(*static_cast<Stored*>(self)));
     }
+
+    static void destroy(void* self) noexcept
+    {
+        static_cast<Stored*>(self)->~Stored();
+    }
+
+    static constexpr lens_vtable<Whole, Part> vtable = {
+        &view, &set, &copy, &move, &destroy};
 };
 
 } // namespace detail
@@ -39,32 +80,90 @@ struct lens_holder : public lens_i<Whole, Part>
 //! @defgroup lenses-api
 //! @{
 
+/*!
+ * Type erased lens from `Whole` to `Part`.
+ *
+ * Lenses that fit in `buffer_size` bytes, which covers most compositions of
+ * the lenses in `lager::lenses`, are stored in place.  Copying them does not
+ * allocate nor touch any reference count.  Bigger lenses are allocated on the
+ * heap and shared among copies.
+ */
 template <typename Whole, typename Part>
 class lens : zug::detail::pipeable
 {
-    std::shared_ptr<detail::lens_i<Whole, Part> const> holder_;
-
 public:
+    static constexpr std::size_t buffer_size = 4 * sizeof(void*);
+
     template <typename Lens,
               typename std::enable_if<
                   !std::is_same_v<std::decay_t<Lens>, std::decay_t<lens>>,
                   int>::type = 0>
     lens(Lens&& lens)
-        : holder_{new detail::lens_holder<std::decay_t<Lens>, Whole, Part>{
-              std::forward<Lens>(lens)}}
-    {}
+    {
+        using lens_t = std::decay_t<Lens>;
+        if constexpr (fits_in_buffer_v<lens_t>) {
+            new (&buffer_) lens_t(std::forward<Lens>(lens));
+            vtable_ = &detail::lens_model<lens_t, Whole, Part>::vtable;
+        } else {
+            using stored_t = std::shared_ptr<const lens_t>;
+            new (&buffer_) stored_t(
+                std::make_shared<const lens_t>(std::forward<Lens>(lens)));
+            vtable_ = &detail::lens_model<stored_t, Whole, Part>::vtable;
+        }
+    }
+
+    lens(const lens& other)
+        : vtable_{other.vtable_}
+    {
+        vtable_->copy(&other.buffer_, &buffer_);
+    }
+
+    lens(lens&& other) noexcept
+        : vtable_{other.vtable_}
+    {
+        vtable_->move(&other.buffer_, &buffer_);
+    }
+
+    lens& operator=(const lens& other)
+    {
+        // copying may throw, so do it before destroying the current lens
+        auto tmp = lens{other};
+        return *this = std::move(tmp);
+    }
+
+    lens& operator=(lens&& other) noexcept
+    {
+        if (this != &other) {
+            vtable_->destroy(&buffer_);
+            vtable_ = other.vtable_;
+            vtable_->move(&other.buffer_, &buffer_);
+        }
+        return *this;
+    }
+
+    ~lens() { vtable_->destroy(&buffer_); }
 
     template <typename F>
     auto operator()(F&& f) const
     {
         return [this, f = std::forward<F>(f)](auto&& p) {
-            return f(holder_->view(std::forward<decltype(p)>(p)))(
+            return f(vtable_->view(&buffer_, std::forward<decltype(p)>(p)))(
                 [&](auto&& x) {
-                    return holder_->set(std::forward<decltype(p)>(p),
+                    return vtable_->set(&buffer_,
+                                        std::forward<decltype(p)>(p),
                                         std::forward<decltype(x)>(x));
                 });
         };
     }
+
+private:
+    template <typename T>
+    static constexpr bool fits_in_buffer_v =
+        sizeof(T) <= buffer_size && alignof(T) <= alignof(std::max_align_t) &&
+        std::is_nothrow_move_constructible_v<T>;
+
+    const detail::lens_vtable<Whole, Part>* vtable_;
+    alignas(std::max_align_t) unsigned char buffer_[buffer_size];
 };
 
 //! @}
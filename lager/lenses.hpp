@@ -107,7 +107,17 @@ auto getset(Getter&& getter, Setter&& setter)
 {
     return zug::comp([=](auto&& f) {
         return [&, f = LAGER_FWD(f)](auto&& p) {
-            return f(getter(std::forward<decltype(p)>(p)))([&](auto&& x) {
+            // the setter is given the whole afterwards, so a getter that
+            // returns a value, and may have taken the whole by value, must
+            // not move it out
+            using part_t = std::invoke_result_t<Getter&, decltype(p)>;
+            auto&& part  = [&]() -> decltype(auto) {
+                if constexpr (std::is_reference_v<part_t>)
+                    return getter(std::forward<decltype(p)>(p));
+                else
+                    return getter(p);
+            }();
+            return f(std::forward<decltype(part)>(part))([&](auto&& x) {
                 return setter(std::forward<decltype(p)>(p),
                               std::forward<decltype(x)>(x));
             });
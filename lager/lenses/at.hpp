@@ -1,13 +1,13 @@
 #pragma once
 
 #include <lager/config.hpp>
+#include <lager/detail/lookup.hpp>
 #include <lager/util.hpp>
 
 #include <zug/compose.hpp>
 #include <zug/meta/detected.hpp>
 
 #include <optional>
-#include <stdexcept>
 #include <utility>
 
 namespace lager {
@@ -29,9 +29,8 @@ std::decay_t<Whole> at_setter_impl(Whole&& whole, Part&& part, Key&& key)
 {
     auto r = std::forward<Whole>(whole);
     if (part.has_value()) {
-        LAGER_TRY {
-            r.at(std::forward<Key>(key)) = std::forward<Part>(part).value();
-        } LAGER_CATCH(std::out_of_range const&) {}
+        if (auto p = ::lager::detail::lookup(r, key))
+            *p = std::forward<Part>(part).value();
     }
     return r;
 }
@@ -44,13 +43,9 @@ template <
                      int> = 0>
 std::decay_t<Whole> at_setter_impl(Whole&& whole, Part&& part, Key&& key)
 {
-    if (part.has_value()) {
-        LAGER_TRY {
-            (void) whole.at(std::forward<Key>(key));
-            return std::forward<Whole>(whole).set(
-                std::forward<Key>(key), std::forward<Part>(part).value());
-        } LAGER_CATCH(std::out_of_range const&) {}
-    }
+    if (part.has_value() && ::lager::detail::contains(whole, key))
+        return std::forward<Whole>(whole).set(std::forward<Key>(key),
+                                              std::forward<Part>(part).value());
     return std::forward<Whole>(whole);
 }
 
@@ -69,11 +64,9 @@ auto at(Key key)
         return [f = LAGER_FWD(f), &key](auto&& whole) {
             using Part = std::optional<std::decay_t<decltype(whole.at(key))>>;
             return f([&]() -> Part {
-                LAGER_TRY {
-                    return LAGER_FWD(whole).at(key);
-                } LAGER_CATCH(std::out_of_range const&) {
-                    return std::nullopt;
-                }
+                if (auto p = ::lager::detail::lookup(whole, key))
+                    return *p;
+                return std::nullopt;
             }())([&](Part part) {
                 return detail::at_setter_impl(
                     LAGER_FWD(whole), std::move(part), key);
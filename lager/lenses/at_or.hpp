@@ -1,13 +1,12 @@
 #pragma once
 
 #include <lager/config.hpp>
+#include <lager/detail/lookup.hpp>
 #include <lager/util.hpp>
 
 #include <zug/compose.hpp>
 #include <zug/meta/detected.hpp>
 
-#include <optional>
-#include <stdexcept>
 #include <utility>
 
 namespace lager {
@@ -28,9 +27,8 @@ template <
 std::decay_t<Whole> at_or_setter_impl(Whole&& whole, Part&& part, Key&& key)
 {
     auto r = std::forward<Whole>(whole);
-    LAGER_TRY {
-        r.at(std::forward<Key>(key)) = std::forward<Part>(part);
-    } LAGER_CATCH(std::out_of_range const&) {}
+    if (auto p = ::lager::detail::lookup(r, key))
+        *p = std::forward<Part>(part);
     return r;
 }
 
@@ -42,11 +40,9 @@ template <
                      int> = 0>
 std::decay_t<Whole> at_or_setter_impl(Whole&& whole, Part&& part, Key&& key)
 {
-    LAGER_TRY {
-        (void) whole.at(std::forward<Key>(key));
+    if (::lager::detail::contains(whole, key))
         return std::forward<Whole>(whole).set(std::forward<Key>(key),
                                               std::forward<Part>(part));
-    } LAGER_CATCH(std::out_of_range const&) {}
     return std::forward<Whole>(whole);
 }
 
@@ -62,11 +58,9 @@ auto at_or(Key key)
         return [f = LAGER_FWD(f), &key](auto&& whole) {
             using Part = std::decay_t<decltype(whole.at(key))>;
             return f([&]() -> Part {
-                LAGER_TRY {
-                    return LAGER_FWD(whole).at(key);
-                } LAGER_CATCH(std::out_of_range const&) {
-                    return Part{};
-                }
+                if (auto p = ::lager::detail::lookup(whole, key))
+                    return *p;
+                return Part{};
             }())([&](auto&& part) {
                 return detail::at_or_setter_impl(
                     LAGER_FWD(whole), LAGER_FWD(part), key);
@@ -85,11 +79,9 @@ auto at_or(Key key, Default&& def)
         return [f = LAGER_FWD(f), &key, &def](auto&& whole) {
             using Part = std::decay_t<decltype(whole.at(key))>;
             return f([&]() -> Part {
-                LAGER_TRY {
-                    return LAGER_FWD(whole).at(key);
-                } LAGER_CATCH(std::out_of_range const&) {
-                    return def;
-                }
+                if (auto p = ::lager::detail::lookup(whole, key))
+                    return *p;
+                return def;
             }())([&](auto&& part) {
                 return detail::at_or_setter_impl(
                     LAGER_FWD(whole), LAGER_FWD(part), key);
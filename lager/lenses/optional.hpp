@@ -26,7 +26,9 @@ auto opt_impl(Lens&& lens)
                 std::declval<std::decay_t<decltype(whole.value())>>()))>>::type;
 
             if (whole.has_value()) {
-                return f(Part{::lager::view(lens, LAGER_FWD(whole).value())})(
+                // the whole is not moved into the view, since the setter may
+                // return it unchanged
+                return f(Part{::lager::view(lens, whole.value())})(
                     [&](Part part) {
                         if (part.has_value()) {
                             return std::decay_t<decltype(whole)>{
@@ -141,7 +143,9 @@ ZUG_INLINE_CONSTEXPR auto or_default = value_or();
 ZUG_INLINE_CONSTEXPR auto force_opt = zug::comp([](auto&& f) {
     return [f = LAGER_FWD(f)](auto&& p) {
         using opt_t = std::optional<std::decay_t<decltype(p)>>;
-        return f(opt_t{LAGER_FWD(p)})(
+        // the whole is not moved into the view, since the setter may return
+        // it unchanged
+        return f(opt_t{p})(
             [&](auto&& x) { return LAGER_FWD(x).value_or(LAGER_FWD(p)); });
     };
 });
@@ -146,8 +146,9 @@ auto zip(Lenses&&... lenses)
         [lens_tuple = std::make_tuple(LAGER_FWD(lenses)...)](auto&& f) {
             return [&, f = LAGER_FWD(f)](auto&& whole_tuple) {
                 using Whole = std::decay_t<decltype(whole_tuple)>;
+                // the whole is only forwarded to the setter, see `getset`
                 return f(detail::apply_zip<Whole>(
-                    detail::fobj_view, lens_tuple, LAGER_FWD(whole_tuple)))(
+                    detail::fobj_view, lens_tuple, whole_tuple))(
                     [&](auto&& part_tuple) {
                         return detail::apply_zip<Whole>(detail::fobj_set,
                                                         lens_tuple,
@@ -24,7 +24,7 @@ struct alternative_t : zug::detail::pipeable
             using Whole = std::decay_t<decltype(p)>;
             return f([&]() -> Part {
                 if (std::holds_alternative<T>(p)) {
-                    return std::get<T>(LAGER_FWD(p));
+                    return std::get<T>(p);
                 } else {
                     return std::nullopt;
                 }
@@ -37,6 +37,16 @@ struct alternative_t : zug::detail::pipeable
             });
         };
     }
+
+    /*!
+     * Pointer to the alternative in `whole`, or null when it holds another
+     * one.  Lens nodes use it to compare and assign the alternative in place.
+     */
+    template <typename Whole>
+    static auto view_ptr(Whole& whole)
+    {
+        return std::get_if<T>(&whole);
+    }
 };
 } // namespace detail
 
@@ -52,6 +52,8 @@ public:
 
     void send_up(const value_type& value) override
     {
+        if (this->batch_send_up(value))
+            return;
         setter_fn_(value);
         this->push_down(value);
         if constexpr (std::is_same_v<TagT, automatic_tag>) {
@@ -63,6 +65,8 @@ public:
 
     void send_up(value_type&& value) override
     {
+        if (this->batch_send_up(std::move(value)))
+            return;
         setter_fn_(value);
         this->push_down(std::move(value));
         if constexpr (std::is_same_v<TagT, automatic_tag>) {
@@ -41,6 +41,8 @@ public:
 
     void send_up(const value_type& value) final
     {
+        if (this->batch_send_up(value))
+            return;
         this->push_down(value);
         if constexpr (std::is_same_v<TagT, automatic_tag>) {
             this->send_down();
@@ -50,6 +52,8 @@ public:
 
     void send_up(value_type&& value) final
     {
+        if (this->batch_send_up(std::move(value)))
+            return;
         this->push_down(std::move(value));
         if constexpr (std::is_same_v<TagT, automatic_tag>) {
             this->send_down();
@@ -0,0 +1,51 @@
+//
+// lager - library for functional interactive c++ programs
+// Copyright (C) 2017 Juan Pedro Bolivar Puente
+//
+// This file is part of lager.
+//
+// lager is free software: you can redistribute it and/or modify
+// it under the terms of the MIT License, as detailed in the LICENSE
+// file located at the root of this source code distribution,
+// or here: <https://github.com/arximboldi/lager/blob/master/LICENSE>
+//
+
+#pragma once
+
+#include <functional>
+#include <utility>
+
+namespace lager {
+
+/*!
+ * Handle to a timer scheduled in an event loop via `post_after()`,
+ * `post_at()` or `post_every()`.  It can be used to cancel the timer before it
+ * fires.  Cancelling a timer that already fired, or cancelling it twice, has
+ * no effect.
+ *
+ * @note This is a reference type and it's life-time is bound to the associated
+ *       event loop.  It is invalid to cancel the timer after the event loop
+ *       has been destructed.
+ */
+class timer_handle
+{
+public:
+    timer_handle() = default;
+
+    explicit timer_handle(std::function<void()> canceller)
+        : cancel_{std::move(canceller)}
+    {}
+
+    void cancel()
+    {
+        if (cancel_)
+            std::exchange(cancel_, nullptr)();
+    }
+
+    explicit operator bool() const { return bool{cancel_}; }
+
+private:
+    std::function<void()> cancel_;
+};
+
+} // namespace lager
@@ -12,16 +12,57 @@
 
 #pragma once
 
+#include <lager/config.hpp>
 #include <lager/detail/access.hpp>
 #include <lager/detail/nodes.hpp>
 #include <lager/detail/smart_lens.hpp>
 #include <lager/watch.hpp>
 
+#include <type_traits>
+#include <utility>
+
 namespace lager {
 
 template <typename NodeT>
 class cursor_base;
 
+namespace detail {
+
+/*!
+ * Keeps a batch open in a node.  The batch should be ended with `commit()`.
+ * Otherwise, when the guard is destroyed during stack unwinding, the batch is
+ * still ended, sending up the values written so far, but the exceptions
+ * thrown while doing so are discarded, since the one being unwound takes
+ * precedence.
+ */
+template <typename NodeT>
+struct batch_guard
+{
+    batch_guard(std::shared_ptr<NodeT> node)
+        : node_{std::move(node)}
+    {
+        node_->begin_batch();
+    }
+
+    batch_guard(const batch_guard&) = delete;
+    batch_guard& operator=(const batch_guard&) = delete;
+
+    ~batch_guard()
+    {
+        if (node_) {
+            LAGER_TRY {
+                node_->end_batch();
+            } LAGER_CATCH(...) {}
+        }
+    }
+
+    void commit() { std::exchange(node_, nullptr)->end_batch(); }
+
+    std::shared_ptr<NodeT> node_;
+};
+
+} // namespace detail
+
 //! @defgroup cursors
 //! @{
 
@@ -37,7 +78,39 @@ struct writer_mixin
     template <typename Fn>
     void update(Fn&& fn)
     {
-        return node_()->send_up(std::forward<Fn>(fn)(node_()->current()));
+        node_()->send_up_with([&](auto&& x) {
+            // callbacks taking an lvalue reference get the current value
+            if constexpr (std::is_invocable_v<Fn, decltype(x)>)
+                return std::forward<Fn>(fn)(LAGER_FWD(x));
+            else
+                return std::forward<Fn>(fn)(std::as_const(x));
+        });
+    }
+
+    /*!
+     * Calls `fn` batching all the writes done during the call through this
+     * cursor or through cursors derived from it.  Instead of updating the
+     * parents of this cursor on every write, the writes are composed, and the
+     * result is sent up once when `fn` returns.  This way, setting multiple
+     * fields of a model only rebuilds the parent values, and propagates
+     * changes when using an `automatic_tag`, once.
+     *
+     * When `fn` throws an exception, the writes it did before are still sent
+     * up, as if it had returned, and then the exception is propagated.  If
+     * sending them up throws too, that second exception is discarded.
+     */
+    template <typename Fn>
+    decltype(auto) transaction(Fn&& fn) const
+    {
+        auto guard = detail::batch_guard{node_()};
+        if constexpr (std::is_void_v<std::invoke_result_t<Fn>>) {
+            std::forward<Fn>(fn)();
+            guard.commit();
+        } else {
+            decltype(auto) result = std::forward<Fn>(fn)();
+            guard.commit();
+            return result;
+        }
     }
 
     template <typename T>
@@ -0,0 +1,331 @@
+//
+// lager - library for functional interactive c++ programs
+// Copyright (C) 2017 Juan Pedro Bolivar Puente
+//
+// This file is part of lager.
+//
+// lager is free software: you can redistribute it and/or modify
+// it under the terms of the MIT License, as detailed in the LICENSE
+// file located at the root of this source code distribution,
+// or here: <https://github.com/arximboldi/lager/blob/master/LICENSE>
+//
+
+#include <catch.hpp>
+
+#include <lager/debug/tree_debugger.hpp>
+#include <lager/extra/cereal/diff.hpp>
+#include <lager/extra/cereal/immer_box.hpp>
+#include <lager/extra/cereal/immer_flex_vector.hpp>
+#include <lager/extra/cereal/immer_map.hpp>
+#include <lager/extra/cereal/immer_vector.hpp>
+#include <lager/extra/cereal/struct.hpp>
+#include <lager/extra/cereal/variant_with_name.hpp>
+#include <lager/extra/struct.hpp>
+
+#include <cereal/archives/json.hpp>
+#include <cereal/types/optional.hpp>
+#include <cereal/types/string.hpp>
+
+#include <immer/flex_vector.hpp>
+#include <immer/map.hpp>
+#include <immer/vector.hpp>
+
+#include <optional>
+#include <sstream>
+#include <string>
+#include <variant>
+#include <vector>
+
+namespace ns {
+struct item
+{
+    std::string name;
+    bool done;
+};
+
+struct model
+{
+    int counter;
+    immer::box<std::string> title;
+    immer::flex_vector<item> items;
+    immer::map<std::string, int> tags;
+    std::optional<int> selected;
+    std::variant<int, std::string> mode;
+    immer::vector<immer::box<item>> boxes;
+};
+} // namespace ns
+
+LAGER_STRUCT(ns, item, name, done);
+LAGER_STRUCT(ns, model, counter, title, items, tags, selected, mode, boxes);
+
+namespace {
+
+std::vector<std::string> diff(const ns::model& a, const ns::model& b)
+{
+    auto builder = lager::detail::diff_builder<cereal::JSONOutputArchive>{};
+    builder.diff("", a, b);
+    auto result = std::vector<std::string>{};
+    for (auto& op : builder.ops)
+        result.push_back(std::string{op.op} + " " + op.path);
+    return result;
+}
+
+ns::model make_model()
+{
+    auto items = immer::flex_vector<ns::item>{};
+    auto boxes = immer::vector<immer::box<ns::item>>{};
+    for (auto i = 0; i < 100; ++i) {
+        items = std::move(items).push_back({std::to_string(i), false});
+        boxes = std::move(boxes).push_back(ns::item{std::to_string(i), false});
+    }
+    return {0, std::string{"title"}, items, {}, std::nullopt, 0, boxes};
+}
+
+using json_t = CEREAL_RAPIDJSON_NAMESPACE::Document;
+
+template <typename T>
+void parse_json(json_t& doc, const T& x)
+{
+    auto os = std::ostringstream{};
+    {
+        auto ar = cereal::JSONOutputArchive{os};
+        ar(cereal::make_nvp("value", x));
+    }
+    doc.Parse(os.str().c_str());
+    REQUIRE(!doc.HasParseError());
+}
+
+// Applies the JSON Patch `patch` to `doc`, supporting the operations that
+// lager::make_diff() emits.
+void apply_patch(json_t& doc, json_t::ValueType& patch)
+{
+    auto& alloc = doc.GetAllocator();
+    REQUIRE(patch.IsArray());
+    for (auto i = CEREAL_RAPIDJSON_NAMESPACE::SizeType{}; i < patch.Size();
+         ++i) {
+        auto& op   = patch[i];
+        auto kind  = std::string{op["op"].GetString()};
+        auto path  = std::string{op["path"].GetString()};
+        auto names = std::vector<std::string>{};
+        for (auto pos = path.find('/'); pos != std::string::npos;) {
+            auto end  = path.find('/', pos + 1);
+            auto name = path.substr(pos + 1, end - pos - 1);
+            for (auto esc = name.find('~'); esc != std::string::npos;
+                 esc      = name.find('~', esc + 1))
+                name.replace(esc, 2, name[esc + 1] == '1' ? "/" : "~");
+            names.push_back(name);
+            pos = end;
+        }
+        auto* parent = &doc["value"];
+        if (names.empty()) {
+            REQUIRE(kind == "replace");
+            parent->CopyFrom(op["value"], alloc);
+            continue;
+        }
+        for (auto n = std::size_t{}; n + 1 < names.size(); ++n)
+            parent = parent->IsArray()
+                         ? &(*parent)[static_cast<CEREAL_RAPIDJSON_NAMESPACE::SizeType>(
+                               std::stoul(names[n]))]
+                         : &(*parent)[names[n].c_str()];
+        auto& last = names.back();
+        if (parent->IsArray()) {
+            auto index = static_cast<CEREAL_RAPIDJSON_NAMESPACE::SizeType>(
+                std::stoul(last));
+            if (kind == "replace") {
+                (*parent)[index].CopyFrom(op["value"], alloc);
+            } else if (kind == "add") {
+                auto x = json_t::ValueType{};
+                x.CopyFrom(op["value"], alloc);
+                parent->PushBack(x, alloc);
+                for (auto j = parent->Size() - 1; j > index; --j)
+                    (*parent)[j].Swap((*parent)[j - 1]);
+            } else {
+                REQUIRE(kind == "remove");
+                parent->Erase(parent->Begin() + index);
+            }
+        } else {
+            REQUIRE(parent->IsObject());
+            parent->RemoveMember(last.c_str());
+            if (kind != "remove") {
+                auto name = json_t::ValueType{};
+                auto x    = json_t::ValueType{};
+                name.SetString(last.c_str(), last.size(), alloc);
+                x.CopyFrom(op["value"], alloc);
+                parent->AddMember(name, x, alloc);
+            }
+        }
+    }
+}
+
+// Checks that patching the JSON of `a` with its diff to `b` results in the
+// JSON of `b`.
+template <typename T>
+void check_patch(const T& a, const T& b)
+{
+    auto doc   = json_t{};
+    auto patch = json_t{};
+    auto next  = json_t{};
+    parse_json(doc, a);
+    parse_json(patch, lager::make_diff(a, b));
+    parse_json(next, b);
+    apply_patch(doc, patch["value"]);
+    CHECK(doc["value"] == next["value"]);
+}
+
+} // namespace
+
+TEST_CASE("diff, same value")
+{
+    auto a = make_model();
+    auto b = a;
+    CHECK(diff(a, b).empty());
+    check_patch(a, b);
+}
+
+TEST_CASE("diff, fields")
+{
+    auto a    = make_model();
+    auto b    = a;
+    b.counter = 1;
+    b.title   = std::string{"other"};
+    CHECK(diff(a, b) == std::vector<std::string>{"replace /counter",
+                                                 "replace /title/value"});
+    check_patch(a, b);
+}
+
+TEST_CASE("diff, optional")
+{
+    auto a     = make_model();
+    auto b     = a;
+    b.selected = 3;
+    CHECK(diff(a, b) == std::vector<std::string>{"replace /selected"});
+    check_patch(a, b);
+    CHECK(diff(b, a) == std::vector<std::string>{"replace /selected"});
+    check_patch(b, a);
+
+    auto c     = b;
+    c.selected = 4;
+    CHECK(diff(b, c) == std::vector<std::string>{"replace /selected/data"});
+    check_patch(b, c);
+}
+
+TEST_CASE("diff, variant")
+{
+    auto a = make_model();
+    auto b = a;
+    b.mode = std::string{"foo"};
+    CHECK(diff(a, b) == std::vector<std::string>{"replace /mode"});
+    check_patch(a, b);
+
+    auto c = b;
+    c.mode = std::string{"bar"};
+    CHECK(diff(b, c) == std::vector<std::string>{"replace /mode/data"});
+    check_patch(b, c);
+}
+
+TEST_CASE("diff, sequences")
+{
+    auto a = make_model();
+
+    SECTION("update")
+    {
+        auto b  = a;
+        b.items = b.items.update(42, [](auto x) {
+            x.done = true;
+            return x;
+        });
+        CHECK(diff(a, b) == std::vector<std::string>{"replace /items/42/done"});
+        check_patch(a, b);
+    }
+
+    SECTION("add")
+    {
+        auto b  = a;
+        b.items = b.items.push_back({"new", false}).push_back({"more", true});
+        CHECK(diff(a, b) ==
+              std::vector<std::string>{"add /items/100", "add /items/101"});
+        check_patch(a, b);
+    }
+
+    SECTION("insert")
+    {
+        auto b  = a;
+        b.items = b.items.insert(10, {"new", false});
+        CHECK(diff(a, b) == std::vector<std::string>{"add /items/10"});
+        check_patch(a, b);
+    }
+
+    SECTION("remove")
+    {
+        auto b  = a;
+        b.items = b.items.erase(10).erase(10);
+        CHECK(diff(a, b) ==
+              std::vector<std::string>{"remove /items/10", "remove /items/10"});
+        check_patch(a, b);
+    }
+}
+
+TEST_CASE("diff, maps")
+{
+    auto a = make_model();
+    a.tags = a.tags.set("a/b", 1).set("c", 2);
+    auto b = a;
+    b.tags = b.tags.set("a/b", 3).erase("c").set("d~", 4);
+    CHECK(diff(a, b) == std::vector<std::string>{"replace /tags"});
+    check_patch(a, b);
+}
+
+TEST_CASE("diff, boxed elements")
+{
+    auto a = make_model();
+
+    SECTION("update")
+    {
+        auto b  = a;
+        b.boxes = b.boxes.set(42, ns::item{"42", true});
+        CHECK(diff(a, b) == std::vector<std::string>{"replace /boxes/42/done"});
+        check_patch(a, b);
+    }
+
+    SECTION("add")
+    {
+        auto b  = a;
+        b.boxes = b.boxes.push_back(ns::item{"new", false});
+        CHECK(diff(a, b) == std::vector<std::string>{"add /boxes/100"});
+        check_patch(a, b);
+    }
+}
+
+TEST_CASE("diff, tree debugger summary")
+{
+    using debugger_t = lager::tree_debugger<int, int, lager::deps<>>;
+    using action_t   = debugger_t::action;
+    using cursor_t   = debugger_t::cursor_t;
+
+    // the patches of the event stream of the http server apply to the
+    // summary as of the previous event
+    auto reducer = [](int model, int action) { return model + action; };
+    auto m       = debugger_t::model{0};
+    auto doc     = json_t{};
+    parse_json(doc, m.summary());
+    auto update = [&](action_t act) {
+        auto old = m;
+        m        = debugger_t::update(reducer, std::move(m), act).first;
+        auto patch = json_t{};
+        auto next  = json_t{};
+        parse_json(patch, lager::make_diff(old.summary(), m.summary()));
+        parse_json(next, m.summary());
+        apply_patch(doc, patch["value"]);
+        CHECK(doc["value"] == next["value"]);
+    };
+
+    for (auto i = 0; i < 5; ++i)
+        update(1);
+    update(debugger_t::goto_action{cursor_t{{0, 2}}});
+    update(2);
+    update(2);
+    update(debugger_t::goto_action{cursor_t{{0, 2}, {0, 0}}});
+    update(3);
+    update(debugger_t::goto_action{cursor_t{{0, 1}}});
+    update(4);
+}
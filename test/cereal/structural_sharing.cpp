@@ -0,0 +1,113 @@
+//
+// lager - library for functional interactive c++ programs
+// Copyright (C) 2017 Juan Pedro Bolivar Puente
+//
+// This file is part of lager.
+//
+// lager is free software: you can redistribute it and/or modify
+// it under the terms of the MIT License, as detailed in the LICENSE
+// file located at the root of this source code distribution,
+// or here: <https://github.com/arximboldi/lager/blob/master/LICENSE>
+//
+
+#include <catch.hpp>
+
+#include <lager/extra/cereal/immer_box.hpp>
+#include <lager/extra/cereal/immer_flex_vector.hpp>
+#include <lager/extra/cereal/immer_vector.hpp>
+#include <lager/extra/cereal/structural_sharing.hpp>
+
+#include <cereal/archives/json.hpp>
+#include <cereal/archives/portable_binary.hpp>
+#include <cereal/types/string.hpp>
+
+#include <sstream>
+#include <string>
+
+namespace {
+
+template <typename OArchive, typename T>
+std::string save(const T& x, bool shared)
+{
+    auto os = std::ostringstream{};
+    if (shared) {
+        auto sharing = lager::structural_sharing{};
+        auto ar      = lager::sharing_archive<OArchive>{sharing, os};
+        ar(x);
+    } else {
+        auto ar = OArchive{os};
+        ar(x);
+    }
+    return os.str();
+}
+
+template <typename IArchive, typename T>
+T load(const std::string& data)
+{
+    auto is      = std::istringstream{data};
+    auto sharing = lager::structural_sharing{};
+    auto ar      = lager::sharing_archive<IArchive>{sharing, is};
+    auto x       = T{};
+    ar(x);
+    return x;
+}
+
+using history_t = immer::flex_vector<immer::flex_vector<std::string>>;
+
+history_t make_history()
+{
+    auto model = immer::flex_vector<std::string>{};
+    for (auto i = 0; i < 100; ++i)
+        model = model.push_back("some long text for item " +
+                                std::to_string(i));
+    auto history = history_t{model};
+    for (auto i = 0; i < 10; ++i) {
+        model   = model.set(i * 7, "changed item " + std::to_string(i));
+        history = history.push_back(model);
+    }
+    return history;
+}
+
+} // namespace
+
+TEST_CASE("structural sharing, history")
+{
+    using oarchive_t = cereal::PortableBinaryOutputArchive;
+    using iarchive_t = cereal::PortableBinaryInputArchive;
+
+    auto history = make_history();
+    auto plain   = save<oarchive_t>(history, false);
+    auto shared  = save<oarchive_t>(history, true);
+    CHECK(shared.size() < plain.size() / 2);
+    CHECK(load<iarchive_t, history_t>(shared) == history);
+}
+
+TEST_CASE("structural sharing, json")
+{
+    using oarchive_t = cereal::JSONOutputArchive;
+    using iarchive_t = cereal::JSONInputArchive;
+
+    auto history = make_history();
+    auto shared  = save<oarchive_t>(history, true);
+    CHECK(shared.size() < save<oarchive_t>(history, false).size());
+    CHECK(load<iarchive_t, history_t>(shared) == history);
+}
+
+TEST_CASE("structural sharing, boxes")
+{
+    using oarchive_t = cereal::PortableBinaryOutputArchive;
+    using iarchive_t = cereal::PortableBinaryInputArchive;
+    using boxes_t    = immer::vector<immer::box<std::string>>;
+
+    auto box    = immer::box<std::string>{std::string(1000, 'x')};
+    auto other  = immer::box<std::string>{"other"};
+    auto boxes  = boxes_t{box, other, box, box};
+    auto shared = save<oarchive_t>(boxes, true);
+    CHECK(shared.size() < 1100);
+
+    auto loaded = load<iarchive_t, boxes_t>(shared);
+    CHECK(loaded == boxes);
+    CHECK(&loaded[0].get() == &loaded[2].get());
+    CHECK(&loaded[0].get() == &loaded[3].get());
+    CHECK(&loaded[0].get() != &loaded[1].get());
+}
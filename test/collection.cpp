@@ -0,0 +1,126 @@
+//
+// lager - library for functional interactive c++ programs
+// Copyright (C) 2017 Juan Pedro Bolivar Puente
+//
+// This file is part of lager.
+//
+// lager is free software: you can redistribute it and/or modify
+// it under the terms of the MIT License, as detailed in the LICENSE
+// file located at the root of this source code distribution,
+// or here: <https://github.com/arximboldi/lager/blob/master/LICENSE>
+//
+
+#include <catch.hpp>
+
+#include <lager/collection.hpp>
+#include <lager/state.hpp>
+
+#include <immer/flex_vector.hpp>
+#include <immer/map.hpp>
+
+#include <string>
+#include <vector>
+
+using namespace lager;
+
+namespace {
+
+template <typename Seq>
+auto to_vector(const Seq& xs)
+{
+    return std::vector<typename Seq::value_type>(xs.begin(), xs.end());
+}
+
+} // namespace
+
+TEST_CASE("collection, each over vector")
+{
+    auto count = 0;
+    auto st    = make_state(immer::flex_vector<int>{1, 2, 3, 4, 5});
+    auto r     = each(st, [&](int x) {
+        ++count;
+        return x * 10;
+    });
+    CHECK(to_vector(r.get()) == std::vector<int>{10, 20, 30, 40, 50});
+    CHECK(count == 5);
+
+    st.update([](auto v) { return v.set(2, 42); });
+    commit(st);
+    CHECK(to_vector(r.get()) == std::vector<int>{10, 20, 420, 40, 50});
+    CHECK(count == 6);
+
+    st.update([](auto v) { return v.push_front(0); });
+    commit(st);
+    CHECK(to_vector(r.get()) == std::vector<int>{0, 10, 20, 420, 40, 50});
+    CHECK(count == 7);
+
+    st.update([](auto v) { return v.take(2); });
+    commit(st);
+    CHECK(to_vector(r.get()) == std::vector<int>{0, 10});
+    CHECK(count == 7);
+}
+
+TEST_CASE("collection, each over map")
+{
+    using map_t = immer::map<int, int>;
+
+    auto count = 0;
+    auto st    = make_state(map_t{}.set(1, 1).set(2, 2), automatic_tag{});
+    auto r     = each(st, [&](int x) {
+        ++count;
+        return std::to_string(x);
+    });
+    CHECK(r.get().size() == 2);
+    CHECK(r.get()[1] == "1");
+    CHECK(count == 2);
+
+    st.update([](auto m) { return m.set(2, 42).set(3, 3).erase(1); });
+    CHECK(r.get().size() == 2);
+    CHECK(r.get()[2] == "42");
+    CHECK(r.get()[3] == "3");
+    CHECK(r.get().count(1) == 0);
+    CHECK(count == 4);
+}
+
+TEST_CASE("collection, filter over vector")
+{
+    auto count = 0;
+    auto st    = make_state(immer::flex_vector<int>{1, 2, 3, 4, 5, 6},
+                         automatic_tag{});
+    auto r     = filter_items(st, [&](int x) {
+        ++count;
+        return x % 2 == 0;
+    });
+    CHECK(to_vector(r.get()) == std::vector<int>{2, 4, 6});
+    CHECK(count == 6);
+
+    st.update([](auto v) { return v.set(2, 8); });
+    CHECK(to_vector(r.get()) == std::vector<int>{2, 8, 4, 6});
+    CHECK(count == 7);
+
+    st.update([](auto v) { return v.erase(1); });
+    CHECK(to_vector(r.get()) == std::vector<int>{8, 4, 6});
+    CHECK(count == 7);
+
+    st.update([](auto v) { return v.push_back(10); });
+    CHECK(to_vector(r.get()) == std::vector<int>{8, 4, 6, 10});
+    CHECK(count == 8);
+
+    st.update([](auto v) { return v.set(4, 7); });
+    CHECK(to_vector(r.get()) == std::vector<int>{8, 4, 10});
+    CHECK(count == 9);
+}
+
+TEST_CASE("collection, filter over map")
+{
+    using map_t = immer::map<int, int>;
+
+    auto st = make_state(map_t{}.set(1, 1).set(2, 2), automatic_tag{});
+    auto r  = filter_items(st, [](int x) { return x % 2 == 0; });
+    CHECK(r.get().size() == 1);
+    CHECK(r.get().count(2) == 1);
+
+    st.update([](auto m) { return m.set(1, 4).set(2, 3); });
+    CHECK(r.get().size() == 1);
+    CHECK(r.get()[1] == 4);
+}
@@ -17,6 +17,7 @@
 
 #include "../example/counter/counter.hpp"
 #include <optional>
+#include <vector>
 
 TEST_CASE("automatic")
 {
@@ -316,3 +317,45 @@ TEST_CASE("composing context with converter")
     ctx2.dispatch(child1_action{});
     CHECK(*store == 2);
 }
+
+TEST_CASE("context ref")
+{
+    auto dispatched = std::vector<std::size_t>{};
+    auto dispatcher = [&](parent_action act) {
+        dispatched.push_back(act.index());
+        return lager::future{};
+    };
+    auto loop = lager::with_manual_event_loop{};
+    auto ctx  = lager::context<parent_action>{dispatcher, loop, {}};
+
+    auto eff1 = [](lager::context_ref<lager::actions<child1_action>> ctx) {
+        ctx.dispatch(child1_action{});
+    };
+    auto eff2 = [&](lager::context_ref<
+                    lager::actions<child1_action, child3_action>> ctx) {
+        ctx.dispatch(child3_action{});
+        eff1(ctx);
+    };
+    auto eff3 = lager::effect<parent_action>{
+        [&](lager::context_ref<parent_action> ctx) {
+            ctx.dispatch(child2_action{});
+            eff2(ctx);
+        }};
+
+    eff3(ctx);
+    CHECK(dispatched == std::vector<std::size_t>{1, 2, 0});
+    CHECK(&lager::context_ref<parent_action>{ctx}.loop() == &ctx.loop());
+}
+
+TEST_CASE("context size does not depend on the number of actions")
+{
+    static_assert(sizeof(lager::context<child1_action>) ==
+                  sizeof(lager::context<parent_action>));
+    static_assert(
+        sizeof(lager::context<child1_action>) ==
+        sizeof(lager::context<
+               lager::actions<child1_action, child2_action, child3_action>>));
+
+    auto ctx = lager::context<lager::actions<child1_action, child2_action>>{};
+    CHECK_THROWS_AS(ctx.dispatch(child1_action{}), std::bad_function_call);
+}
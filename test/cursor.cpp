@@ -20,11 +20,13 @@
 
 #include <lager/lenses.hpp>
 #include <lager/lenses/tuple.hpp>
+#include <lager/lenses/variant.hpp>
 
 #include <boost/fusion/include/adapt_struct.hpp>
 #include <boost/fusion/include/comparison.hpp>
 
 #include <immer/vector.hpp>
+#include <string>
 #include <vector>
 
 #include "spies.hpp"
@@ -217,3 +219,157 @@ TEST_CASE("lenses over with expression")
     CHECK(person_data->name == "new name");
     CHECK(name.get() == "new name");
 }
+
+namespace {
+
+struct copy_counter
+{
+    static inline int copies = 0;
+
+    copy_counter() = default;
+    copy_counter(copy_counter&&) = default;
+    copy_counter(const copy_counter&) { ++copies; }
+    copy_counter& operator=(copy_counter&&) = default;
+    copy_counter& operator=(const copy_counter&)
+    {
+        ++copies;
+        return *this;
+    }
+
+    bool operator==(const copy_counter&) const { return true; }
+};
+
+struct inner_model
+{
+    copy_counter payload;
+    int value = 0;
+
+    bool operator==(const inner_model& x) const { return value == x.value; }
+};
+
+struct outer_model
+{
+    inner_model inner;
+    copy_counter payload;
+
+    bool operator==(const outer_model& x) const { return inner == x.inner; }
+};
+
+} // namespace
+
+TEST_CASE("writing through lenses copies the root once")
+{
+    auto st = make_state(outer_model{});
+    auto c  = st[&outer_model::inner][&inner_model::value].make();
+
+    copy_counter::copies = 0;
+    c.set(42);
+    CHECK(copy_counter::copies == 2);
+
+    copy_counter::copies = 0;
+    c.update([](int x) { return x + 1; });
+    CHECK(copy_counter::copies == 2);
+
+    commit(st);
+    CHECK(st->inner.value == 43);
+    CHECK(c.get() == 43);
+}
+
+TEST_CASE("zooming into a variant alternative")
+{
+    using variant_t = std::variant<inner_model, int>;
+
+    auto st  = make_state(variant_t{inner_model{}}, automatic_tag{});
+    auto alt = st[lenses::alternative<inner_model>].make();
+    auto spy = testing::spy();
+    watch(alt, spy);
+
+    alt.set(inner_model{{}, 42});
+    CHECK(std::get<inner_model>(st.get()).value == 42);
+    CHECK(alt->value().value == 42);
+    CHECK(spy.count() == 1);
+
+    copy_counter::copies = 0;
+    alt.set(std::nullopt);
+    CHECK(std::get<inner_model>(st.get()).value == 42);
+    CHECK(copy_counter::copies == 1);
+    CHECK(spy.count() == 1);
+
+    st.set(variant_t{5});
+    CHECK(!alt.get());
+    CHECK(spy.count() == 2);
+
+    alt.set(inner_model{{}, 1});
+    CHECK(std::get<int>(st.get()) == 5);
+    CHECK(spy.count() == 2);
+
+    st.set(variant_t{inner_model{{}, 7}});
+    alt.update([](auto x) {
+        x->value += 1;
+        return x;
+    });
+    CHECK(std::get<inner_model>(st.get()).value == 8);
+    CHECK(alt->value().value == 8);
+    CHECK(spy.count() == 4);
+}
+
+namespace {
+
+struct mouse
+{
+    std::vector<int> eyes;
+    std::string name;
+
+    bool operator==(const mouse& x) const
+    {
+        return eyes == x.eyes && name == x.name;
+    }
+};
+
+} // namespace
+
+TEST_CASE("writing through lenses keeps the rest of the whole")
+{
+    auto st   = make_state(mouse{{1, 2}, "jerry"});
+    auto eyes = lenses::getset([](mouse m) { return m.eyes; },
+                               [](mouse m, std::vector<int> x) {
+                                   m.eyes = std::move(x);
+                                   return m;
+                               });
+
+    SECTION("getset")
+    {
+        auto c = st.zoom(eyes).make();
+        c.set(std::vector<int>{3, 4});
+        commit(st);
+        CHECK(st->eyes == std::vector<int>{3, 4});
+        CHECK(st->name == "jerry");
+
+        c.update([](auto x) {
+            x.push_back(5);
+            return x;
+        });
+        commit(st);
+        CHECK(st->eyes == std::vector<int>{3, 4, 5});
+        CHECK(st->name == "jerry");
+    }
+
+    SECTION("zip")
+    {
+        auto st2 = make_state(std::make_tuple(mouse{{1}, "tom"}, 5));
+        auto c   = st2.zoom(lenses::zip(eyes, lager::identity)).make();
+        c.set(std::make_tuple(std::vector<int>{7}, 6));
+        commit(st2);
+        CHECK(std::get<0>(*st2).eyes == std::vector<int>{7});
+        CHECK(std::get<0>(*st2).name == "tom");
+        CHECK(std::get<1>(*st2) == 6);
+    }
+
+    SECTION("update with an lvalue reference")
+    {
+        auto c = st[&mouse::name].make();
+        c.update([](auto& x) { return x + "!"; });
+        commit(st);
+        CHECK(st->name == "jerry!");
+    }
+}
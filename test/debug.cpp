@@ -13,6 +13,7 @@
 #include <catch.hpp>
 
 #include <lager/debug/debugger.hpp>
+#include <lager/debug/tree_debugger.hpp>
 #include <lager/event_loop/manual.hpp>
 #include <lager/store.hpp>
 
@@ -105,3 +106,114 @@ TEST_CASE("effect with dependencies")
     store.dispatch(2);
     CHECK(called == 1);
 }
+
+TEST_CASE("bounded history")
+{
+    using debugger_t = lager::debugger<int, int, lager::deps<>>;
+    using action_t   = debugger_t::action;
+
+    auto reducer = [](int model, int action) { return model + action; };
+    auto sum     = [](int n) { return n * (n + 1) / 2; };
+    auto m       = debugger_t::model{0, lager::debugger_limits{10, 4, 3}};
+    auto update  = [&](action_t act) {
+        m = debugger_t::update(reducer, std::move(m), act).first;
+    };
+
+    for (auto i = 1; i <= 100; ++i)
+        update(i);
+    CHECK(m.history.size() == 10);
+    CHECK(m.cursor == 10);
+    CHECK(m.init == sum(90));
+    CHECK(static_cast<const int&>(m) == sum(100));
+
+    auto models = 0;
+    for (auto&& step : m.history)
+        models += step.model.has_value();
+    CHECK(models <= 6);
+
+    CHECK(m.lookup(5).second == sum(95));
+    CHECK(*m.lookup(5).first == 95);
+
+    update(debugger_t::goto_action{2});
+    CHECK(static_cast<const int&>(m) == sum(92));
+    update(debugger_t::undo_action{});
+    CHECK(static_cast<const int&>(m) == sum(91));
+    update(debugger_t::redo_action{});
+    CHECK(static_cast<const int&>(m) == sum(92));
+
+    update(1000);
+    CHECK(m.history.size() == 3);
+    CHECK(static_cast<const int&>(m) == sum(92) + 1000);
+}
+
+TEST_CASE("tree debugger checkpoints")
+{
+    using debugger_t = lager::tree_debugger<int, int, lager::deps<>>;
+    using action_t   = debugger_t::action;
+    using cursor_t   = debugger_t::cursor_t;
+
+    auto replays = 0;
+    auto reducer = [&](int model, int action) {
+        ++replays;
+        return model + action;
+    };
+    auto limits = lager::tree_debugger_limits{.checkpoint_interval = 4};
+    auto m      = debugger_t::model{0, limits};
+    auto update = [&](action_t act) {
+        m = debugger_t::update(reducer, std::move(m), act).first;
+    };
+
+    for (auto i = 1; i <= 10; ++i)
+        update(1);
+    CHECK(static_cast<const int&>(m) == 10);
+    CHECK(!m.branches[0][9]->model);
+    CHECK(m.branches[0][7]->model == 8);
+
+    replays = 0;
+    update(debugger_t::goto_action{cursor_t{{0, 5}}});
+    CHECK(static_cast<const int&>(m) == 6);
+    CHECK(replays == 2);
+
+    replays = 0;
+    CHECK(m.lookup(cursor_t{{0, 5}}).second == 6);
+    CHECK(replays == 0);
+
+    update(100);
+    CHECK(static_cast<const int&>(m) == 106);
+    update(debugger_t::undo_action{});
+    CHECK(static_cast<const int&>(m) == 6);
+    CHECK(m.lookup(cursor_t{{0, 9}}).second == 10);
+}
+
+TEST_CASE("tree debugger summary")
+{
+    using debugger_t = lager::tree_debugger<int, int, lager::deps<>>;
+    using action_t   = debugger_t::action;
+    using cursor_t   = debugger_t::cursor_t;
+
+    auto reducer = [](int model, int action) { return model + action; };
+    auto m       = debugger_t::model{0};
+    auto update  = [&](action_t act) {
+        m = debugger_t::update(reducer, std::move(m), act).first;
+        CHECK(m.summary() == m.do_summary(m.branches));
+    };
+
+    for (auto i = 1; i <= 10; ++i)
+        update(i);
+    update(debugger_t::goto_action{cursor_t{{0, 4}}});
+    update(100);
+    update(101);
+    CHECK(static_cast<const int&>(m) == 15 + 201);
+    update(debugger_t::goto_action{cursor_t{{0, 4}}});
+    update(200);
+    CHECK(m.cursor == cursor_t{{0, 4}, {1, 0}});
+    update(debugger_t::goto_action{cursor_t{{0, 4}, {0, 0}}});
+    update(300);
+    update(debugger_t::goto_action{cursor_t{{0, 7}}});
+    update(400);
+    update(debugger_t::goto_action{cursor_t{}});
+    update(500);
+    CHECK(m.cursor == cursor_t{{1, 0}});
+    CHECK(static_cast<const int&>(m) == 500);
+    CHECK(m.summary().size() == 2);
+}
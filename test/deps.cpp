@@ -14,6 +14,11 @@
 
 #include <lager/deps.hpp>
 
+#include <atomic>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
 struct foo
 {
     int x = 0;
@@ -185,3 +190,59 @@ TEST_CASE("extracting from function")
     f1.x = 13;
     CHECK(d2.get<foo>().x == 13);
 }
+
+TEST_CASE("lazy")
+{
+    auto built = 0;
+    auto d1    = lager::make_deps(lager::dep::as<lager::dep::lazy<foo>>([&] {
+        ++built;
+        return foo{42};
+    }));
+    auto d2    = lager::deps<lager::dep::lazy<foo>>{d1};
+    CHECK(built == 0);
+
+    CHECK(d2.get<foo>().x == 42);
+    CHECK(built == 1);
+
+    d1.get<foo>().x = 13;
+    CHECK(d2.get<foo>().x == 13);
+    CHECK(built == 1);
+
+    auto d3 = lager::deps<foo&>{d1};
+    CHECK(d3.get<foo>().x == 13);
+    CHECK(built == 1);
+}
+
+TEST_CASE("lazy retries on exception")
+{
+    auto built = 0;
+    auto d1    = lager::make_deps(
+        lager::dep::as<lager::dep::key<foo1, lager::dep::lazy<int>>>([&] {
+            if (built++ == 0)
+                throw std::runtime_error{"noo!"};
+            return 42;
+        }));
+    CHECK_THROWS(d1.get<foo1>());
+    CHECK(d1.get<foo1>() == 42);
+    CHECK(built == 2);
+}
+
+TEST_CASE("prewarm")
+{
+    auto built = std::atomic<int>{0};
+    auto d1    = lager::make_deps(
+        lager::dep::as<lager::dep::lazy<foo>>([&] {
+            ++built;
+            return foo{42};
+        }),
+        lager::dep::as<
+            lager::dep::opt<lager::dep::key<foo1, lager::dep::lazy<int>>>>(
+            std::nullopt));
+    auto threads = std::vector<std::thread>{};
+    for (auto i = 0; i < 8; ++i)
+        threads.emplace_back([d1] { lager::prewarm(d1); });
+    for (auto& t : threads)
+        t.join();
+    CHECK(built == 1);
+    CHECK(d1.get<foo>().x == 42);
+}
@@ -17,6 +17,9 @@
 
 #include "example/counter/counter.hpp"
 
+#include <chrono>
+#include <vector>
+
 TEST_CASE("basic")
 {
     auto ctx   = boost::asio::io_context{};
@@ -50,3 +53,66 @@ TEST_CASE("modern strand")
     ctx.run();
     CHECK(store->value == 1);
 }
+
+TEST_CASE("concurrent effects")
+{
+    auto main_id    = std::this_thread::get_id();
+    auto worker_ids = std::vector<std::thread::id>(2);
+    auto effect1    = lager::effect<int>{[&](auto&& ctx) {
+        worker_ids[0] = std::this_thread::get_id();
+        ctx.dispatch(1);
+    }};
+    auto effect2    = lager::effect<int>{[&](auto&& ctx) {
+        worker_ids[1] = std::this_thread::get_id();
+        ctx.dispatch(2);
+    }};
+
+    auto ctx   = boost::asio::io_context{};
+    auto store = lager::make_store<int>(
+        0,
+        lager::with_boost_asio_event_loop{ctx.get_executor()},
+        lager::with_futures,
+        lager::with_reducer([&](int s, int a) -> lager::result<int, int> {
+            if (a == 0)
+                return {s,
+                        lager::parallel(lager::concurrent(effect1),
+                                        lager::concurrent(effect2))};
+            else
+                return s + a;
+        }));
+
+    auto called = 0;
+    store.dispatch(0).then([&] {
+        CHECK(std::this_thread::get_id() == main_id);
+        ++called;
+    });
+    ctx.run();
+
+    CHECK(called == 1);
+    CHECK(*store == 3);
+    CHECK(worker_ids[0] != std::thread::id{});
+    CHECK(worker_ids[0] != main_id);
+    CHECK(worker_ids[1] != std::thread::id{});
+    CHECK(worker_ids[1] != main_id);
+}
+
+TEST_CASE("timers")
+{
+    using namespace std::chrono_literals;
+    auto ctx   = boost::asio::io_context{};
+    auto loop  = lager::with_boost_asio_event_loop{ctx.get_executor()};
+    auto fired = std::vector<int>{};
+    auto ticks = 0;
+
+    loop.post_after(2ms, [&] { fired.push_back(1); });
+    loop.post_after(1ms, [&] { fired.push_back(2); });
+    loop.post_after(1ms, [&] { fired.push_back(3); }).cancel();
+    auto h = lager::timer_handle{};
+    h      = loop.post_every(1ms, [&] {
+        if (++ticks == 3)
+            h.cancel();
+    });
+    ctx.run();
+    CHECK(fired == std::vector<int>{2, 1});
+    CHECK(ticks == 3);
+}
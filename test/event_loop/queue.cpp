@@ -17,6 +17,10 @@
 
 #include "example/counter/counter.hpp"
 
+#include <chrono>
+#include <thread>
+#include <vector>
+
 TEST_CASE("basic")
 {
     auto queue = lager::queue_event_loop{};
@@ -44,3 +48,62 @@ TEST_CASE("exception")
     loop.step();
     CHECK(called == 1);
 }
+
+TEST_CASE("timers")
+{
+    using namespace std::chrono_literals;
+    auto loop  = lager::queue_event_loop{};
+    auto fired = std::vector<int>{};
+
+    loop.post_after(2ms, [&] { fired.push_back(1); });
+    loop.post_after(1h, [&] { fired.push_back(2); });
+    auto h = loop.post_after(2ms, [&] { fired.push_back(3); });
+    loop.post_after(0ms, [&] { fired.push_back(4); });
+    h.cancel();
+
+    std::this_thread::sleep_for(10ms);
+    loop.step();
+    CHECK(fired == std::vector<int>{4, 1});
+
+    loop.step();
+    CHECK(fired == std::vector<int>{4, 1});
+}
+
+TEST_CASE("periodic timers")
+{
+    using namespace std::chrono_literals;
+    auto loop   = lager::queue_event_loop{};
+    auto called = 0;
+
+    auto h = loop.post_every(1ms, [&] { ++called; });
+    std::this_thread::sleep_for(10ms);
+    loop.step();
+    CHECK(called == 1);
+
+    std::this_thread::sleep_for(10ms);
+    loop.step();
+    CHECK(called == 2);
+
+    h.cancel();
+    std::this_thread::sleep_for(10ms);
+    loop.step();
+    CHECK(called == 2);
+}
+
+TEST_CASE("many timers")
+{
+    using namespace std::chrono_literals;
+    auto loop    = lager::queue_event_loop{};
+    auto called  = 0;
+    auto handles = std::vector<lager::timer_handle>{};
+
+    for (auto i = 0; i < 100000; ++i)
+        handles.push_back(loop.post_after(
+            std::chrono::milliseconds{i % 2 ? 1 : i}, [&] { ++called; }));
+    for (auto i = 0; i < 100000; i += 2)
+        handles[i].cancel();
+
+    std::this_thread::sleep_for(10ms);
+    loop.step();
+    CHECK(called == 50000);
+}
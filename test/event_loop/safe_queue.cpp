@@ -17,6 +17,11 @@
 
 #include "example/counter/counter.hpp"
 
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
 TEST_CASE("basic")
 {
     auto queue = lager::safe_queue_event_loop{};
@@ -65,3 +70,23 @@ TEST_CASE("exception")
     loop.step();
     CHECK(called == 1);
 }
+
+TEST_CASE("timers from threads")
+{
+    using namespace std::chrono_literals;
+    auto called  = std::atomic<int>{0};
+    auto loop    = lager::safe_queue_event_loop{};
+    auto threads = std::vector<std::thread>{};
+
+    for (auto i = 0; i < 10; ++i)
+        threads.push_back(std::thread([&] {
+            loop.post_after(1ms, [&] { ++called; });
+            loop.post_after(1h, [&] { ++called; });
+        }));
+    for (auto&& t : threads)
+        t.join();
+
+    std::this_thread::sleep_for(10ms);
+    loop.step();
+    CHECK(called == 10);
+}
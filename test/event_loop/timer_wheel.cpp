@@ -0,0 +1,132 @@
+//
+// lager - library for functional interactive c++ programs
+// Copyright (C) 2017 Juan Pedro Bolivar Puente
+//
+// This file is part of lager.
+//
+// lager is free software: you can redistribute it and/or modify
+// it under the terms of the MIT License, as detailed in the LICENSE
+// file located at the root of this source code distribution,
+// or here: <https://github.com/arximboldi/lager/blob/master/LICENSE>
+//
+
+#include <catch.hpp>
+
+#include <lager/detail/timer_wheel.hpp>
+
+#include <chrono>
+#include <vector>
+
+using namespace std::chrono_literals;
+
+using lager::detail::timer_wheel;
+
+namespace {
+
+// the wheel is driven with made up time points instead of the real clock
+struct fake_wheel
+{
+    timer_wheel::time_point now = {};
+    timer_wheel wheel{now, 1ms};
+    std::vector<int> fired;
+
+    auto add(timer_wheel::duration delay,
+             int id,
+             timer_wheel::duration period = {})
+    {
+        return wheel.add(now + delay, [this, id] { fired.push_back(id); },
+                         period);
+    }
+
+    void advance(timer_wheel::duration d)
+    {
+        now += d;
+        wheel.advance(now, [](auto&& fn) { fn(); });
+    }
+};
+
+} // namespace
+
+TEST_CASE("timer wheel, timers fire in order")
+{
+    auto w = fake_wheel{};
+    w.add(3ms, 3);
+    w.add(1ms, 1);
+    w.add(2ms, 2);
+    w.advance(5ms);
+    CHECK(w.fired == std::vector<int>{1, 2, 3});
+    CHECK(w.wheel.empty());
+}
+
+TEST_CASE("timer wheel, timers never fire early")
+{
+    auto w = fake_wheel{};
+    w.add(1500us, 1);
+    w.advance(1ms);
+    CHECK(w.fired.empty());
+    w.advance(499us);
+    CHECK(w.fired.empty());
+    w.advance(501us);
+    CHECK(w.fired == std::vector<int>{1});
+}
+
+TEST_CASE("timer wheel, timers due now fire in the next tick")
+{
+    auto w = fake_wheel{};
+    w.add(0ms, 1);
+    w.advance(0ms);
+    CHECK(w.fired.empty());
+    w.advance(1ms);
+    CHECK(w.fired == std::vector<int>{1});
+}
+
+TEST_CASE("timer wheel, periodic timers are rounded up")
+{
+    auto w = fake_wheel{};
+    w.add(1500us, 1, 1500us);
+    w.advance(1ms);
+    CHECK(w.fired.empty());
+    w.advance(1ms);
+    CHECK(w.fired == std::vector<int>{1});
+    w.advance(1ms);
+    CHECK(w.fired == std::vector<int>{1, 1});
+    w.advance(1ms);
+    CHECK(w.fired == std::vector<int>{1, 1});
+}
+
+TEST_CASE("timer wheel, periodic timers do not drift")
+{
+    auto w = fake_wheel{};
+    w.add(1500us, 1, 1500us);
+    for (auto i = 0; i < 300; ++i)
+        w.advance(1ms);
+    CHECK(w.fired.size() == 200);
+
+    // missed periods are skipped, but the timer keeps its phase
+    w.advance(10ms);
+    CHECK(w.fired.size() == 201);
+    for (auto i = 0; i < 30; ++i)
+        w.advance(1ms);
+    CHECK(w.fired.size() == 221);
+}
+
+TEST_CASE("timer wheel, cancel")
+{
+    auto w  = fake_wheel{};
+    auto id = w.add(2ms, 1);
+    w.add(2ms, 2);
+    CHECK(w.wheel.cancel(id));
+    CHECK(!w.wheel.cancel(id));
+    w.advance(2ms);
+    CHECK(w.fired == std::vector<int>{2});
+}
+
+TEST_CASE("timer wheel, far timers skip idle time")
+{
+    auto w = fake_wheel{};
+    w.add(1h, 1);
+    w.advance(1h - 1ms);
+    CHECK(w.fired.empty());
+    w.advance(1ms);
+    CHECK(w.fired == std::vector<int>{1});
+}
@@ -19,6 +19,8 @@
 #include <lager/extra/derive/eq.hpp>
 #include <lager/extra/derive/hana.hpp>
 #include <lager/extra/derive/hash.hpp>
+#include <lager/extra/derive/lenses.hpp>
+#include <lager/lenses.hpp>
 
 #include <boost/hana/assert.hpp>
 #include <boost/hana/equal.hpp>
@@ -62,6 +64,21 @@ void check_cereal()
     CHECK(y == x);
 }
 
+template <typename T>
+void check_lenses()
+{
+    using lenses = lager::field_lenses<T>;
+    auto x       = T{42, 12};
+    CHECK(lager::view(lenses::a, x) == 42);
+    CHECK(lager::view(lenses::b, x) == 12);
+    auto y = lager::set(lenses::a, x, 5);
+    CHECK(y.a == 5);
+    CHECK(y.b == 12);
+    auto z = lager::over(lenses::b, std::move(y), [](auto b) { return b + 1; });
+    CHECK(z.a == 5);
+    CHECK(z.b == 13);
+}
+
 template <typename T>
 void check_hash()
 {
@@ -79,7 +96,7 @@ struct derived
     float b;
 };
 } // namespace ns
-LAGER_DERIVE((EQ, HANA, CEREAL, HASH), ns, derived, a, b);
+LAGER_DERIVE((EQ, HANA, CEREAL, HASH, LENSES), ns, derived, a, b);
 
 TEST_CASE("basic")
 {
@@ -87,6 +104,7 @@ TEST_CASE("basic")
     check_hana<ns::derived>();
     check_cereal<ns::derived>();
     check_hash<ns::derived>();
+    check_lenses<ns::derived>();
 }
 
 namespace ns {
@@ -96,7 +114,7 @@ struct derived2
     float b;
 };
 } // namespace ns
-LAGER_DERIVE((EQ, HANA, CEREAL, HASH), ns, derived2, a, b);
+LAGER_DERIVE((EQ, HANA, CEREAL, HASH, LENSES), ns, derived2, a, b);
 
 TEST_CASE("basic-2")
 {
@@ -104,6 +122,12 @@ TEST_CASE("basic-2")
     // check_hana<ns::derived2>();
     check_cereal<ns::derived2>();
     check_hash<ns::derived2>();
+
+    using lenses = lager::field_lenses<ns::derived2>;
+    auto x       = ns::derived2{{1, 2}, 3};
+    auto deep    = lenses::a | lager::field_lenses<ns::derived>::b;
+    CHECK(lager::view(deep, x) == 2);
+    CHECK(lager::set(deep, x, 5).a.b == 5);
 }
 
 namespace ns {
@@ -128,8 +152,12 @@ struct foo_tpl
     B b;
 };
 } // namespace ns
-LAGER_DERIVE_TEMPLATE(
-    (EQ, HANA, CEREAL, HASH), ns, (class A, class B), (foo_tpl<A, B>), a, b);
+LAGER_DERIVE_TEMPLATE((EQ, HANA, CEREAL, HASH, LENSES),
+                      ns,
+                      (class A, class B),
+                      (foo_tpl<A, B>),
+                      a,
+                      b);
 
 TEST_CASE("template")
 {
@@ -137,6 +165,7 @@ TEST_CASE("template")
     check_hana<ns::foo_tpl<int, float>>();
     check_cereal<ns::foo_tpl<int, float>>();
     check_hash<ns::foo_tpl<int, float>>();
+    check_lenses<ns::foo_tpl<int, float>>();
 }
 
 namespace ns {
@@ -147,7 +176,7 @@ struct foo_tpl2
     {
         A a;
         B b;
-        LAGER_DERIVE_NESTED((EQ, HANA, CEREAL), nested, a, b);
+        LAGER_DERIVE_NESTED((EQ, HANA, CEREAL, LENSES), nested, a, b);
     };
 };
 } // namespace ns
@@ -157,4 +186,5 @@ TEST_CASE("template_nested")
     check_eq<ns::foo_tpl2<int, float>::nested>();
     check_hana<ns::foo_tpl2<int, float>::nested>();
     check_cereal<ns::foo_tpl2<int, float>::nested>();
+    check_lenses<ns::foo_tpl2<int, float>::nested>();
 }
@@ -0,0 +1,196 @@
+//
+// lager - library for functional interactive c++ programs
+// Copyright (C) 2017 Juan Pedro Bolivar Puente
+//
+// This file is part of lager.
+//
+// lager is free software: you can redistribute it and/or modify
+// it under the terms of the MIT License, as detailed in the LICENSE
+// file located at the root of this source code distribution,
+// or here: <https://github.com/arximboldi/lager/blob/master/LICENSE>
+//
+
+#include <catch.hpp>
+
+#include <lager/event_loop/manual.hpp>
+#include <lager/extra/cereal/struct.hpp>
+#include <lager/extra/cereal/variant_with_name.hpp>
+#include <lager/extra/journal.hpp>
+#include <lager/store.hpp>
+
+#include "../../example/counter/counter.hpp"
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+namespace {
+
+std::string journal_path()
+{
+    auto path = std::filesystem::temp_directory_path() / "lager-journal-test";
+    std::filesystem::remove(path);
+    std::filesystem::remove(path.string() + ".snapshot");
+    return path.string();
+}
+
+auto make_counter_store(const std::string& path)
+{
+    return lager::make_store<counter::action>(counter::model{},
+                                              lager::with_manual_event_loop{},
+                                              lager::with_journal(path));
+}
+
+} // namespace
+
+TEST_CASE("journal, actions are replayed")
+{
+    auto path = journal_path();
+    {
+        auto store = make_counter_store(path);
+        CHECK(store->value == 0);
+        store.dispatch(counter::increment_action{});
+        store.dispatch(counter::reset_action{42});
+        store.dispatch(counter::decrement_action{});
+        CHECK(store->value == 41);
+    }
+    {
+        auto store = make_counter_store(path);
+        CHECK(store->value == 41);
+        store.dispatch(counter::increment_action{});
+    }
+    {
+        auto store = make_counter_store(path);
+        CHECK(store->value == 42);
+    }
+}
+
+TEST_CASE("journal, effects are not evaluated when replaying")
+{
+    auto path   = journal_path();
+    auto called = 0;
+    auto make   = [&] {
+        return lager::make_store<int>(
+            0,
+            lager::with_manual_event_loop{},
+            lager::with_reducer([&](int model, int action) {
+                return std::pair{model + action,
+                                 lager::effect<int>{[&](auto&&) { ++called; }}};
+            }),
+            lager::with_journal(path));
+    };
+    {
+        auto store = make();
+        store.dispatch(2);
+        store.dispatch(3);
+        CHECK(called == 2);
+    }
+    {
+        auto store = make();
+        CHECK(store.get() == 5);
+        CHECK(called == 2);
+    }
+}
+
+TEST_CASE("journal, incomplete records are discarded")
+{
+    auto path = journal_path();
+    {
+        auto store = make_counter_store(path);
+        store.dispatch(counter::reset_action{5});
+    }
+    {
+        auto os = std::ofstream{path, std::ios::binary | std::ios::app};
+        os.write("\x40\x00\x00\x00\x01", 5);
+    }
+    {
+        auto store = make_counter_store(path);
+        CHECK(store->value == 5);
+        store.dispatch(counter::increment_action{});
+    }
+    {
+        auto store = make_counter_store(path);
+        CHECK(store->value == 6);
+    }
+}
+
+TEST_CASE("journal, corrupt records are not discarded")
+{
+    auto path = journal_path();
+    {
+        auto store = make_counter_store(path);
+        store.dispatch(counter::reset_action{5});
+    }
+    {
+        auto os = std::ofstream{path, std::ios::binary | std::ios::app};
+        os.write("\x01\x00\x00\x00\xff", 5);
+    }
+    auto size = std::filesystem::file_size(path);
+    CHECK_THROWS_AS(make_counter_store(path), std::runtime_error);
+    CHECK(std::filesystem::file_size(path) == size);
+}
+
+TEST_CASE("journal, snapshots")
+{
+    auto path    = journal_path();
+    auto reduced = 0;
+    auto make    = [&] {
+        return lager::make_store<counter::action>(
+            counter::model{},
+            lager::with_manual_event_loop{},
+            lager::with_reducer([&](counter::model m, counter::action a) {
+                ++reduced;
+                return counter::update(m, a);
+            }),
+            lager::with_journal(path, lager::journal_snapshots{2}));
+    };
+    {
+        auto store = make();
+        store.dispatch(counter::reset_action{10});
+        store.dispatch(counter::increment_action{});
+        store.dispatch(counter::increment_action{});
+        store.dispatch(counter::increment_action{});
+        store.dispatch(counter::decrement_action{});
+        CHECK(store->value == 12);
+    }
+    CHECK(std::filesystem::exists(path + ".snapshot"));
+
+    reduced = 0;
+    {
+        auto store = make();
+        CHECK(store->value == 12);
+        CHECK(reduced == 1);
+        store.dispatch(counter::increment_action{});
+        store.dispatch(counter::increment_action{});
+    }
+
+    reduced = 0;
+    {
+        auto store = make();
+        CHECK(store->value == 14);
+        CHECK(reduced == 0);
+    }
+}
+
+TEST_CASE("journal, corrupt records after a snapshot are not discarded")
+{
+    auto path = journal_path();
+    auto make = [&] {
+        return lager::make_store<counter::action>(
+            counter::model{},
+            lager::with_manual_event_loop{},
+            lager::with_journal(path, lager::journal_snapshots{1}));
+    };
+    {
+        auto store = make();
+        store.dispatch(counter::reset_action{10});
+        store.dispatch(counter::increment_action{});
+    }
+    {
+        auto os = std::ofstream{path, std::ios::binary | std::ios::app};
+        os.write("\x01\x00\x00\x00\xff", 5);
+    }
+    auto size = std::filesystem::file_size(path);
+    CHECK_THROWS_AS(make(), std::runtime_error);
+    CHECK(std::filesystem::file_size(path) == size);
+}
@@ -0,0 +1,144 @@
+//
+// lager - library for functional interactive c++ programs
+// Copyright (C) 2017 Juan Pedro Bolivar Puente
+//
+// This file is part of lager.
+//
+// lager is free software: you can redistribute it and/or modify
+// it under the terms of the MIT License, as detailed in the LICENSE
+// file located at the root of this source code distribution,
+// or here: <https://github.com/arximboldi/lager/blob/master/LICENSE>
+//
+
+#include <catch.hpp>
+
+#include <lager/debug/http_server.hpp>
+
+#include <cstdint>
+#include <string>
+
+using lager::detail::http::params;
+using lager::detail::http::router;
+using verb = boost::beast::http::verb;
+
+namespace {
+
+// Returns a handler that responds with `name` followed by the value of the
+// parameters in `names`.
+template <typename... Names>
+router::handler_t respond(std::string name, Names... names)
+{
+    return [=](router::req_t&&, const params& ps) {
+        auto res   = router::res_t{};
+        res.body() = name;
+        ((res.body() += " " + ps.get<std::string>(names)), ...);
+        return res;
+    };
+}
+
+router::handler_t respond_uint(std::string name, std::string param)
+{
+    return [=](router::req_t&&, const params& ps) {
+        auto res   = router::res_t{};
+        res.body() = name + " " + std::to_string(ps.get<std::uint64_t>(param));
+        return res;
+    };
+}
+
+struct response
+{
+    unsigned status;
+    std::string body;
+};
+
+response request(const router& r, verb method, std::string target)
+{
+    auto req = router::req_t{};
+    req.method(method);
+    req.target(target);
+    auto m   = r.match(req);
+    auto res = r.handle_request(std::move(req), m);
+    return {res.result_int(), res.body()};
+}
+
+router make_router()
+{
+    auto r = router{};
+    r.route(verb::get, "/api", respond("status"))
+        .route(verb::get,
+               "/api/step/{cursor:uint}",
+               respond_uint("step", "cursor"))
+        .route(verb::get, "/api/step/last", respond("last"))
+        .route(verb::get, "/api/{name}", respond("name", "name"))
+        .route(verb::post, "/api/undo", respond("undo"))
+        .route(verb::get, "/{path*}", respond("file", "path"));
+    return r;
+}
+
+} // namespace
+
+TEST_CASE("http router, literals take precedence over parameters")
+{
+    auto r = make_router();
+    CHECK(request(r, verb::get, "/api/step/last").body == "last");
+    CHECK(request(r, verb::get, "/api/step/3").body == "step 3");
+    CHECK(request(r, verb::get, "/api/undo").body == "name undo");
+    CHECK(request(r, verb::get, "/api/foo").body == "name foo");
+}
+
+TEST_CASE("http router, uint parameters")
+{
+    auto r = make_router();
+    CHECK(request(r, verb::get, "/api/step/0").body == "step 0");
+    CHECK(request(r, verb::get, "/api/step/18446744073709551615").body ==
+          "step 18446744073709551615");
+
+    SECTION("non digits")
+    {
+        CHECK(request(r, verb::get, "/api/step/abc").body ==
+              "file api/step/abc");
+        CHECK(request(r, verb::get, "/api/step/12a").body ==
+              "file api/step/12a");
+        CHECK(request(r, verb::get, "/api/step/-1").body == "file api/step/-1");
+        CHECK(request(r, verb::get, "/api/step/+1").body == "file api/step/+1");
+    }
+
+    SECTION("overflow")
+    {
+        CHECK(request(r, verb::get, "/api/step/18446744073709551616").body ==
+              "file api/step/18446744073709551616");
+    }
+}
+
+TEST_CASE("http router, rest parameters")
+{
+    auto r = make_router();
+    CHECK(request(r, verb::get, "/").body == "file ");
+    CHECK(request(r, verb::get, "/gui/app.js").body == "file gui/app.js");
+    CHECK(request(r, verb::get, "/api/step/3/more").body ==
+          "file api/step/3/more");
+    CHECK(request(r, verb::get, "/api/").body == "status");
+    CHECK(request(r, verb::get, "/api").body == "status");
+}
+
+TEST_CASE("http router, empty segments and queries")
+{
+    auto r = make_router();
+    CHECK(request(r, verb::get, "//api//step///3").body == "step 3");
+    CHECK(request(r, verb::get, "/api/step/3/").body == "step 3");
+    CHECK(request(r, verb::get, "/api/step/3?foo=bar/baz").body == "step 3");
+    CHECK(request(r, verb::get, "/api?step=3").body == "status");
+    CHECK(request(r, verb::get, "/?x=1").body == "file ");
+}
+
+TEST_CASE("http router, method mismatch")
+{
+    auto r = make_router();
+    CHECK(request(r, verb::post, "/api/undo").body == "undo");
+
+    auto res = request(r, verb::post, "/api/step/3");
+    CHECK(res.status == 404);
+    CHECK(res.body == "Not found");
+    CHECK(request(r, verb::delete_, "/api/undo").status == 404);
+    CHECK(request(r, verb::put, "/index.html").status == 404);
+}
@@ -0,0 +1,170 @@
+//
+// lager - library for functional interactive c++ programs
+// Copyright (C) 2017 Juan Pedro Bolivar Puente
+//
+// This file is part of lager.
+//
+// lager is free software: you can redistribute it and/or modify
+// it under the terms of the MIT License, as detailed in the LICENSE
+// file located at the root of this source code distribution,
+// or here: <https://github.com/arximboldi/lager/blob/master/LICENSE>
+//
+
+#include <catch.hpp>
+
+#include <lager/keyed.hpp>
+#include <lager/state.hpp>
+
+#include <immer/flex_vector.hpp>
+#include <immer/map.hpp>
+
+#include <string>
+#include <vector>
+
+#include "spies.hpp"
+
+using namespace lager;
+
+TEST_CASE("keyed, immer map")
+{
+    using map_t = immer::map<int, std::string>;
+
+    auto st   = make_state(map_t{}.set(1, "foo").set(2, "bar"));
+    auto rows = keyed(st);
+    auto r1   = rows[1];
+    auto r2   = rows[2];
+    auto r3   = rows[3];
+
+    CHECK(r1.get() == "foo");
+    CHECK(r2.get() == "bar");
+    CHECK(r3.get() == std::nullopt);
+
+    auto s1 = testing::spy();
+    auto s2 = testing::spy();
+    auto s3 = testing::spy();
+    watch(r1, s1);
+    watch(r2, s2);
+    watch(r3, s3);
+
+    st.update([](auto m) { return m.set(1, "baz"); });
+    commit(st);
+    CHECK(r1.get() == "baz");
+    CHECK(s1.count() == 1);
+    CHECK(s2.count() == 0);
+    CHECK(s3.count() == 0);
+
+    st.update([](auto m) { return m.erase(2).set(3, "qux"); });
+    commit(st);
+    CHECK(r2.get() == std::nullopt);
+    CHECK(r3.get() == "qux");
+    CHECK(s1.count() == 1);
+    CHECK(s2.count() == 1);
+    CHECK(s3.count() == 1);
+}
+
+TEST_CASE("keyed, vector")
+{
+    auto st   = make_state(std::vector<int>{1, 2, 3}, automatic_tag{});
+    auto rows = keyed(st);
+    auto r0   = rows[0];
+    auto r2   = rows[2];
+
+    auto s0 = testing::spy();
+    auto s2 = testing::spy();
+    watch(r0, s0);
+    watch(r2, s2);
+
+    st.set(std::vector<int>{1, 2, 42});
+    CHECK(r2.get() == 42);
+    CHECK(s0.count() == 0);
+    CHECK(s2.count() == 1);
+
+    st.set(std::vector<int>{5});
+    CHECK(r0.get() == 5);
+    CHECK(r2.get() == std::nullopt);
+    CHECK(s0.count() == 1);
+    CHECK(s2.count() == 2);
+}
+
+TEST_CASE("keyed, children can be released")
+{
+    auto st   = make_state(std::vector<int>{1, 2, 3}, automatic_tag{});
+    auto rows = keyed(st);
+    {
+        auto r = rows[1];
+        CHECK(r.get() == 2);
+    }
+    auto r = rows[1];
+    st.set(std::vector<int>{1, 5, 3});
+    CHECK(r.get() == 5);
+}
+
+namespace {
+
+struct row
+{
+    int id;
+    std::string text;
+
+    bool operator==(const row& x) const
+    {
+        return id == x.id && text == x.text;
+    }
+    bool operator!=(const row& x) const { return !(*this == x); }
+};
+
+} // namespace
+
+TEST_CASE("keyed, cursors by element key")
+{
+    using vector_t = immer::flex_vector<row>;
+
+    auto st   = make_state(vector_t{{1, "foo"}, {2, "bar"}}, automatic_tag{});
+    auto rows = keyed(st, [](const row& r) { return r.id; });
+    auto r1   = rows[1];
+    auto r2   = rows[2];
+    auto r3   = rows[3];
+    CHECK(r1->value().text == "foo");
+    CHECK(r2->value().text == "bar");
+    CHECK(!r3.get());
+
+    auto s1 = testing::spy();
+    auto s2 = testing::spy();
+    auto s3 = testing::spy();
+    watch(r1, s1);
+    watch(r2, s2);
+    watch(r3, s3);
+
+    SECTION("inserting does not update other elements")
+    {
+        st.update([](auto v) { return v.push_front(row{3, "baz"}); });
+        CHECK(r3->value().text == "baz");
+        CHECK(s1.count() == 0);
+        CHECK(s2.count() == 0);
+        CHECK(s3.count() == 1);
+
+        st.update([](auto v) { return v.erase(1); });
+        CHECK(!r1.get());
+        CHECK(s1.count() == 1);
+        CHECK(s2.count() == 0);
+    }
+
+    SECTION("writing")
+    {
+        st.update([](auto v) { return v.push_front(row{0, "qux"}); });
+        r2.set(row{2, "changed"});
+        CHECK(st->size() == 3);
+        CHECK((*st)[2].text == "changed");
+        CHECK(s1.count() == 0);
+        CHECK(s2.count() == 1);
+
+        r3.set(row{3, "new"});
+        CHECK(st->size() == 4);
+        CHECK(st->back().text == "new");
+
+        r1.set(std::nullopt);
+        CHECK(st->size() == 3);
+        CHECK(!r1.get());
+        CHECK(s1.count() == 1);
+    }
+}
@@ -12,6 +12,7 @@
 
 #include <catch.hpp>
 
+#include <immer/map.hpp>
 #include <immer/vector.hpp>
 #include <zug/compose.hpp>
 #include <zug/util.hpp>
@@ -25,6 +26,7 @@
 #include <lager/lenses/tuple.hpp>
 
 #include <array>
+#include <map>
 
 struct yearday
 {
@@ -143,6 +145,25 @@ TEST_CASE("lenses, at")
     CHECK(view(first_name, set(first_name, v1, "bar")) == "bar");
 }
 
+TEST_CASE("lenses, at with keys")
+{
+    auto foo = at(std::string{"foo"});
+    auto bar = at_or(std::string{"bar"}, 42);
+
+    auto m1 = std::map<std::string, int>{{"foo", 1}};
+    CHECK(view(foo, m1) == 1);
+    CHECK(view(bar, m1) == 42);
+    CHECK(set(foo, m1, 2) == std::map<std::string, int>{{"foo", 2}});
+    CHECK(set(bar, m1, 2) == m1);
+    CHECK(view(at(-1), std::vector<int>{1}) == std::nullopt);
+
+    auto m2 = immer::map<std::string, int>{}.set("foo", 1);
+    CHECK(view(foo, m2) == 1);
+    CHECK(view(bar, m2) == 42);
+    CHECK(view(foo, set(foo, m2, 2)) == 2);
+    CHECK(set(bar, m2, 2) == m2);
+}
+
 // This is an alternative definition of lager::lenses::attr using
 // lager::lens::getset.  The standard definition is potentially more efficient
 // whene the whole lens can not be optimized away, because there is only one
@@ -264,6 +285,18 @@ TEST_CASE("lenses, value_or")
     CHECK(view(first_name, set(first_name, v1, "bar")) == "bar");
 }
 
+TEST_CASE("lenses, force_opt")
+{
+    using opt_t = std::optional<std::string>;
+    auto name   = attr(&person::name) | force_opt;
+
+    auto p1 = person{{}, "foo"};
+    CHECK(view(name, p1) == "foo");
+    CHECK(set(name, p1, opt_t{"bar"}).name == "bar");
+    CHECK(set(name, p1, opt_t{}).name == "foo");
+    CHECK(set(force_opt, std::string{"foo"}, opt_t{}) == "foo");
+}
+
 TEST_CASE("lenses, alternative")
 {
     auto the_person = alternative<person>;
@@ -281,6 +314,13 @@ TEST_CASE("lenses, alternative")
     CHECK(view(person_name, set(alternative<person>, v1, person{{}, "bar"})) ==
           "bar");
     CHECK(view(person_name, set(person_name, v1, "bar")) == "bar");
+
+    auto v2 = set(the_person, std::move(v1), std::nullopt);
+    CHECK(view(person_name, v2) == "foo");
+    auto v3 = set(with_opt(attr(&person::name)),
+                  std::optional<person>{person{{}, "baz"}},
+                  std::nullopt);
+    CHECK(v3->name == "baz");
 }
 
 TEST_CASE("lenses, with_opt")
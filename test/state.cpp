@@ -18,6 +18,8 @@
 
 #include "spies.hpp"
 
+#include <stdexcept>
+
 using namespace lager;
 
 struct no_default_ctr
@@ -247,3 +249,58 @@ TEST_CASE("state, check notifications after direct assignment to state")
     CHECK(childSpy.count() == 1);
     CHECK(parentSpy.count() == 1);
 }
+
+TEST_CASE("state, transaction batches writes")
+{
+    lager::state<TestNS::Parent, automatic_tag> state;
+    lager::cursor<TestNS::Child> child = state[&TestNS::Parent::child];
+    lager::cursor<int> parent_value = state[&TestNS::Parent::parentValue];
+    lager::cursor<int> child_value  = child[&TestNS::Child::childValue];
+
+    auto parentSpy = testing::spy();
+    watch(state, parentSpy);
+
+    state.transaction([&] {
+        parent_value.set(42);
+        child_value.set(5);
+        child_value.update([](int x) { return x + 8; });
+        CHECK(parentSpy.count() == 0);
+    });
+
+    CHECK(state.get().parentValue == 42);
+    CHECK(state.get().child.childValue == 13);
+    CHECK(parentSpy.count() == 1);
+
+    SECTION("nested in derived cursors")
+    {
+        child.transaction([&] {
+            child_value.set(1);
+            state.transaction([&] { child_value.set(2); });
+            CHECK(parentSpy.count() == 1);
+        });
+        CHECK(state.get().child.childValue == 2);
+        CHECK(parentSpy.count() == 2);
+    }
+
+    SECTION("writes before an exception are sent up")
+    {
+        CHECK_THROWS_AS(state.transaction([&] {
+            parent_value.set(7);
+            throw std::runtime_error{"error"};
+        }),
+                        std::runtime_error);
+        CHECK(state.get().parentValue == 7);
+        CHECK(parentSpy.count() == 2);
+        parent_value.set(8);
+        CHECK(parentSpy.count() == 3);
+    }
+
+    SECTION("returns the result of the function")
+    {
+        CHECK(state.transaction([&] {
+            parent_value.set(1);
+            return 5;
+        }) == 5);
+        CHECK(parentSpy.count() == 2);
+    }
+}
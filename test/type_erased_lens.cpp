@@ -12,6 +12,7 @@
 
 #include <catch.hpp>
 
+#include <array>
 #include <vector>
 
 #include <zug/compose.hpp>
@@ -165,3 +166,32 @@ TEST_CASE("type erased lenses, nesting")
         CHECK(view(lens, set(lens, t1, expected)) == expected);
     }
 }
+
+TEST_CASE("type erased lenses, copies")
+{
+    using te_lens = lens<tree, size_t>;
+
+    // this lens is too big for the small buffer and is stored in the heap
+    auto offset = std::array<size_t, 16>{};
+    offset[15]  = 10;
+    te_lens big = getset(
+        [offset](const tree& x) { return x.value + offset[15]; },
+        [offset](tree x, size_t v) {
+            x.value = v - offset[15];
+            return x;
+        });
+    te_lens small = attr(&tree::value);
+
+    auto t1     = tree{42};
+    auto lenses = std::vector<te_lens>{small, big, small, big};
+    lenses.erase(lenses.begin());
+    CHECK(view(lenses[0], t1) == 52);
+    CHECK(view(lenses[1], t1) == 42);
+
+    auto moved = std::move(lenses[0]);
+    lenses[0]  = lenses[1];
+    lenses[1]  = moved;
+    CHECK(view(lenses[0], t1) == 42);
+    CHECK(view(lenses[1], t1) == 52);
+    CHECK(view(lenses[1], set(lenses[1], t1, 100)) == 100);
+}
@@ -457,3 +457,38 @@ TEST_CASE("mix cursor and reader")
     auto i                                 = make_state(std::string{"john"});
     reader<std::tuple<int, std::string>> r = with(c, i);
 }
+
+TEST_CASE("xformed, refresh only recomputes when parents change")
+{
+    using namespace lager::detail;
+
+    auto count = 0;
+    auto inc   = [&](int x) {
+        ++count;
+        return x + 1;
+    };
+    auto x = make_state_node(0);
+    auto y = make_xform_reader_node(zug::map(inc), std::make_tuple(x));
+    auto z = make_xform_reader_node(zug::map(inc), std::make_tuple(y));
+    count  = 0;
+
+    z->refresh();
+    z->refresh();
+    CHECK(2 == z->current());
+    CHECK(0 == count);
+
+    x->push_down(5);
+    z->refresh();
+    CHECK(7 == z->current());
+    CHECK(2 == count);
+
+    z->refresh();
+    CHECK(2 == count);
+
+    // a change in an unrelated node makes refresh walk the ancestors again,
+    // but they are not recomputed
+    auto w = make_state_node(0);
+    w->push_down(1);
+    z->refresh();
+    CHECK(2 == count);
+}